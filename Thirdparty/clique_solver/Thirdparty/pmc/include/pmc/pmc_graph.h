@@ -55,7 +55,9 @@ namespace pmc {
             pmc_graph(const string& filename);
             pmc_graph(bool graph_stats, const string& filename);
             pmc_graph(const string& filename, bool make_adj);
+            // CSR graph, buffers passed with std::move are adopted without a copy
             pmc_graph(vector<long long> vs, vector<int> es) {
+                initialize();
                 edges = std::move(es);
                 vertices = std::move(vs);
                 vertex_degrees();
@@ -66,6 +68,14 @@ namespace pmc {
             // destructor
             ~pmc_graph();
 
+            // moves the CSR buffers out to reuse their capacity, the graph is empty afterwards
+            void release(vector<long long>& vs, vector<int>& es) {
+                vs = std::move(vertices);
+                es = std::move(edges);
+                vertices.clear();
+                edges.clear();
+            }
+
             void read_graph(const string& filename);
             void create_adj();
             void reduce_graph(int* &pruned);
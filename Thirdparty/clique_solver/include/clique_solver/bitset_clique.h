@@ -0,0 +1,68 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_BITSET_CLIQUE_H
+#define SRC_BITSET_CLIQUE_H
+
+#include <vector>
+#include <cstdint>
+#include <chrono>
+
+namespace clique_solver {
+
+    /**
+     * Exact maximum clique by bit-parallel coloring branch and bound (BBMC):
+     * P. San Segundo, D. Rodriguez-Losada, A. Jimenez, "An exact bit-parallel algorithm for the maximum clique
+     * problem", Computers & Operations Research, vol. 38, no. 2, pp. 571-581, 2011.
+     *
+     * Candidate sets and adjacency rows are bitsets of 64-bit words, so intersections, greedy coloring and the
+     * popcount bound of a branch cost V / 64 word operations. Suited to dense graphs, where the adjacency of the
+     * V vertices that survive the core pruning, V^2 / 8 bytes, is small.
+     */
+    class BitsetCliqueSolver {
+    public:
+        /**
+         * @param offsets CSR offsets, see Graph::toCSR
+         * @param neighbors CSR neighbours
+         * @param lower_bound only cliques larger than this are searched for, as with PMC
+         * @param time_limit in seconds, the largest clique found so far is returned when it runs out
+         * @return the vertices of the maximum clique, empty if none is larger than lower_bound
+         */
+        std::vector<int> solve(const std::vector<long long> &offsets, const std::vector<int> &neighbors,
+                               int lower_bound = 0, double time_limit = 3600);
+
+        // branches explored by the last solve
+        size_t numBranches() const { return num_branches_; }
+
+    private:
+        // core number of every vertex (Batagelj-Zaversnik bucket peeling), and the peeling order
+        static void coreNumbers(const std::vector<long long> &offsets, const std::vector<int> &neighbors,
+                                std::vector<int> *cores, std::vector<int> *order);
+
+        // greedy sequential coloring of the candidates at depth, keeps the vertices of color >= k_min
+        void color(int depth, int k_min);
+
+        void expand(int depth);
+
+        uint64_t *candidates(int depth) { return &candidates_[depth * num_words_]; }
+
+        const uint64_t *row(int v) const { return &adj_[size_t(v) * num_words_]; }
+
+        int num_vertices_ = 0, num_words_ = 0;
+        std::vector<uint64_t> adj_;
+        // candidates of each depth, then the two coloring scratch sets
+        std::vector<uint64_t> candidates_, uncolored_, color_class_;
+        // branching vertices of each depth and their colors, in increasing color
+        std::vector<std::vector<int>> order_, colors_;
+        std::vector<int> vertices_, clique_, best_;
+        int best_size_ = 0;
+        size_t num_branches_ = 0;
+        bool timed_out_ = false;
+        std::chrono::steady_clock::time_point deadline_;
+    };
+}
+
+#endif //SRC_BITSET_CLIQUE_H
@@ -39,6 +39,30 @@ namespace clipper {
         ///< removes some randomness of the initial guess;
         ///< i.e., after one step of power method, random
         ///< u0's look similar.
+
+        bool use_csr = false; ///< Keep M and C of a graph in one CSR built from its
+        ///< edges (CSRAffinity) instead of sparse matrices
+        ///< taken from its dense adjacency matrix, and run
+        ///< the products of each gradient step row-parallel.
+    };
+
+    /**
+     * @brief      Affinity and constraint matrices sharing one symmetric CSR
+     *             pattern, both triangles stored and no diagonal. The neighbours
+     *             of vertex i are neighbors[offsets[i]] up to
+     *             neighbors[offsets[i + 1]]. C is one on every stored entry, M is
+     *             weights, or equal to C when weights is empty. Memory is
+     *             O(N + E) against O(N^2) for the dense adjacency matrix.
+     */
+    struct CSRAffinity {
+        std::vector<long long> offsets;
+        std::vector<int> neighbors;
+        std::vector<double> weights;
+
+        size_t bytes() const {
+            return offsets.size() * sizeof(long long) + neighbors.size() * sizeof(int) +
+                   weights.size() * sizeof(double);
+        }
     };
 
     /**
@@ -65,6 +89,24 @@ namespace clipper {
 
         virtual ~CLIPPER() {}
 
+        /**
+         * @brief      Take the affinity and constraint matrices of a binary
+         *             consistency graph, as CSR if params.use_csr. The CSR buffers
+         *             keep their capacity, so one instance can solve graph after
+         *             graph without reallocating.
+         *
+         * @param[in]  graph  Consistency graph, with initAffinityMatrix called
+         *                    unless params.use_csr
+         */
+        void setGraph(const clique_solver::Graph &graph);
+
+        /**
+         * @brief      Find the dense clique from u0. The u of the solution of a
+         *             previous, sparser graph over the same vertices (e.g. the
+         *             previous level of a pyramid) is a warm start.
+         *
+         * @param[in]  u0    Initial vector, random if empty
+         */
         virtual void solve(const Eigen::VectorXd &u0 = Eigen::VectorXd());
 
         const Solution &getSolution() const { return soln_; }
@@ -84,17 +126,44 @@ namespace clipper {
          */
         void setSparseMatrixData(const clique_solver::SpAffinity &M, const clique_solver::SpConstraint &C);
 
+        /**
+         * @brief      Directly set the affinity and constraint matrices as CSR,
+         *             solve() then uses it whatever params.use_csr is.
+         *
+         * @param[in]  csr   Shared CSR of M and C, moved in
+         */
+        void setCSRData(CSRAffinity csr);
+
         void setParallelize(bool parallelize) { parallelize_ = parallelize; };
 
     protected:
         Params params_;
 
-        bool parallelize_ = true; ///< should affinity calculation be parallelized
+        bool parallelize_ = true; ///< should affinity calculation and CSR products be parallelized
 
         // \brief Problem data from latest instance of data association
         Solution soln_; ///< solution information from CLIPPER dense clique solver
         clique_solver::SpAffinity M_; ///< affinity matrix (i.e., weighted consistency graph)
         clique_solver::SpConstraint C_; ///< constraint matrix (i.e., prevents forming links)
+        CSRAffinity csr_; ///< M and C as CSR, used instead of M_ and C_ when not empty
+
+        /**
+         * @brief      Gradient of the objective at u,
+         *             (1 + d) u - d 1 1^T u + (M + d C) u, with M and C stored
+         *             without their unit diagonal. Uses csr if it is not empty, M
+         *             and C otherwise.
+         */
+        void gradient(const clique_solver::SpAffinity &M, const clique_solver::SpConstraint &C,
+                      const CSRAffinity &csr, const Eigen::VectorXd &u, double d, Eigen::VectorXd *grad) const;
+
+        /**
+         * @brief      Terms of the increase of d, Mu = (M + I) u and
+         *             Cbu = (1 1^T - C - I) u, from one pass over the edges. Cbu
+         *             may be null.
+         */
+        void penaltyTerms(const clique_solver::SpAffinity &M, const clique_solver::SpConstraint &C,
+                          const CSRAffinity &csr, const Eigen::VectorXd &u, Eigen::VectorXd *Mu,
+                          Eigen::VectorXd *Cbu) const;
 
         /**
          * @brief      Identifies a dense clique of an undirected graph G from its
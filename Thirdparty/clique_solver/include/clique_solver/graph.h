@@ -164,24 +164,90 @@ namespace clique_solver {
             }
         }
 
-		// Method to prune the graph safely
-		void pruneGraph(int degree) {
-			std::vector<int> verticesToRemove;
-		
-			// Step 1: Find all vertices that need to be removed
-			for (size_t i = 0; i < adj_list_.size(); ++i) {
-				if (adj_list_[i].size() < static_cast<size_t>(degree)) {
-					verticesToRemove.push_back(i);
-				}
-			}
-		
-			// Step 2: Remove the vertices and associated edges
-			// Iterate in reverse to avoid shifting indices of yet-to-be-removed vertices
-			for (auto it = verticesToRemove.rbegin(); it != verticesToRemove.rend(); ++it) {
-				removeVertex(*it);
-			}
-		}
-	
+        /**
+         * Remove the vertices of degree less than the given one. Removing a vertex lowers the degree of its
+         * neighbours, so vertices are peeled until every remaining vertex has at least that degree (the k-core
+         * of the graph), then the graph is compacted in one pass. Vertices keep their order, a vertex of a
+         * clique of size k + 1 is never removed for k.
+         * @param [in] degree minimum degree of the remaining vertices
+         * @return the new index of each old vertex, -1 for removed vertices
+         */
+        std::vector<int> pruneGraph(int degree) {
+            const int num_v = adj_list_.size();
+            std::vector<int> old_to_new(num_v, 0);
+            std::vector<int> degrees(num_v), peel;
+            for (int i = 0; i < num_v; ++i) {
+                degrees[i] = adj_list_[i].size();
+                if (degrees[i] < degree) {
+                    old_to_new[i] = -1;
+                    peel.push_back(i);
+                }
+            }
+            // each edge is visited at most twice, once from each removed end
+            while (!peel.empty()) {
+                const int v = peel.back();
+                peel.pop_back();
+                for (const int &u: adj_list_[v]) {
+                    if (old_to_new[u] >= 0 && --degrees[u] < degree) {
+                        old_to_new[u] = -1;
+                        peel.push_back(u);
+                    }
+                }
+            }
+
+            int num_kept = 0;
+            for (int i = 0; i < num_v; ++i) {
+                if (old_to_new[i] >= 0) {
+                    old_to_new[i] = num_kept++;
+                }
+            }
+            if (num_kept == num_v) {
+                return old_to_new;
+            }
+
+            // new indices never exceed old ones, so the lists are filtered and moved down in place
+            num_edges_ = 0;
+            for (int i = 0; i < num_v; ++i) {
+                if (old_to_new[i] < 0) {
+                    continue;
+                }
+                auto &edges = adj_list_[i];
+                size_t kept = 0;
+                for (const int &e: edges) {
+                    if (old_to_new[e] >= 0) {
+                        edges[kept++] = old_to_new[e];
+                    }
+                }
+                edges.resize(kept);
+                num_edges_ += kept;
+                if (old_to_new[i] != i) {
+                    adj_list_[old_to_new[i]].swap(edges);
+                }
+            }
+            adj_list_.resize(num_kept);
+            num_edges_ /= 2;
+
+            if (use_adj_matrix_ && M_.rows() == num_v) {
+                Eigen::MatrixXd M = Eigen::MatrixXd::Zero(num_kept, num_kept);
+                for (int j = 0; j < num_v; ++j) {
+                    for (int i = 0; i < num_v && old_to_new[j] >= 0; ++i) {
+                        if (old_to_new[i] >= 0) {
+                            M(old_to_new[i], old_to_new[j]) = M_(i, j);
+                        }
+                    }
+                }
+                M_.swap(M);
+            }
+            // an unset (empty) affinity or constraint stays unset
+            if (affinity_.rows() == num_v) {
+                affinity_ = compact(affinity_, old_to_new, num_kept);
+            }
+            if (constraint_.rows() == num_v) {
+                constraint_ = compact(constraint_, old_to_new, num_kept);
+            }
+            return old_to_new;
+        }
+
 		// Method to safely remove a vertex and its associated edges
 		void removeVertex(int vertex) {
 			// Remove all edges associated with the vertex
@@ -300,6 +366,25 @@ namespace clique_solver {
 
         [[nodiscard]] std::vector<std::vector<int>> getAdjList() const { return adj_list_; }
 
+        /**
+         * Write the graph in CSR form: the neighbours of vertex i are neighbors[offsets[i]] up to
+         * neighbors[offsets[i + 1]]. The buffers are overwritten but keep their capacity, so the same buffers can
+         * be reused from graph to graph.
+         * @param [out] offsets numVertices() + 1 offsets
+         * @param [out] neighbors 2 * numEdges() vertex ids
+         */
+        void toCSR(std::vector<long long> *offsets, std::vector<int> *neighbors) const {
+            offsets->resize(adj_list_.size() + 1);
+            (*offsets)[0] = 0;
+            for (size_t i = 0; i < adj_list_.size(); ++i) {
+                (*offsets)[i + 1] = (*offsets)[i] + adj_list_[i].size();
+            }
+            neighbors->resize(offsets->back());
+            for (size_t i = 0; i < adj_list_.size(); ++i) {
+                std::copy(adj_list_[i].begin(), adj_list_[i].end(), neighbors->begin() + (*offsets)[i]);
+            }
+        }
+
         /**
          * Preallocate spaces for vertices
          * @param num_vertices
@@ -363,6 +448,22 @@ namespace clique_solver {
         }
 
     private:
+        // the entries of a square sparse matrix between kept vertices, renumbered
+        static SpMat compact(const SpMat &mat, const std::vector<int> &old_to_new, int num_kept) {
+            std::vector<Eigen::Triplet<double>> triplets;
+            triplets.reserve(mat.nonZeros());
+            for (int k = 0; k < mat.outerSize(); ++k) {
+                for (SpMat::InnerIterator it(mat, k); it; ++it) {
+                    if (old_to_new[it.row()] >= 0 && old_to_new[it.col()] >= 0) {
+                        triplets.emplace_back(old_to_new[it.row()], old_to_new[it.col()], it.value());
+                    }
+                }
+            }
+            SpMat compacted(num_kept, num_kept);
+            compacted.setFromTriplets(triplets.begin(), triplets.end());
+            return compacted;
+        }
+
         std::vector<std::vector<int>> adj_list_;
         size_t num_edges_;
         SpAffinity affinity_;
@@ -20,6 +20,10 @@
  * 1302.6256, 2013.
  */
 
+namespace pmc {
+    class pmc_graph;
+}
+
 namespace clique_solver {
     class MaxCliqueSolver {
     public:
@@ -30,6 +34,7 @@ namespace clique_solver {
             PMC_EXACT = 0,
             PMC_HEU = 1,
             KCORE_HEU = 2,
+            BITSET = 3,
         };
 
         /**
@@ -59,6 +64,16 @@ namespace clique_solver {
              * Time limit on running the solver.
              */
             double time_limit = 3600;
+
+            /**
+             * With auto_bitset in PMC_EXACT mode, graphs at least bitset_density_threshold dense and with at most
+             * bitset_max_vertices vertices are solved by the bit-parallel coloring solver (BitsetCliqueSolver)
+             * instead of PMC's branch and bound. Off by default: the thresholds were measured against PMC on one
+             * thread, while PMC runs on 12. BITSET mode always uses the bitset solver.
+             */
+            bool auto_bitset = false;
+            double bitset_density_threshold = 0.05;
+            int bitset_max_vertices = 20000;
         };
 
         MaxCliqueSolver() = default;
@@ -71,9 +86,23 @@ namespace clique_solver {
          * @param graph
          * @return a vector of indices of cliques
          */
-        std::vector<int> findMaxClique(Graph graph, int lower_bound = 0);
+        std::vector<int> findMaxClique(const Graph &graph, int lower_bound = 0);
+
+        /**
+         * Find the maximum clique of a graph in CSR form, see Graph::toCSR. The buffers are handed to PMC
+         * without a copy and given back with their capacity on return, for the next graph. PMC may reorder
+         * the neighbours of a vertex.
+         * @param offsets numVertices() + 1 offsets into neighbors
+         * @param neighbors the neighbours of every vertex
+         * @return a vector of indices of cliques
+         */
+        std::vector<int> findMaxClique(std::vector<long long> &offsets, std::vector<int> &neighbors,
+                                       int lower_bound = 0);
 
     private:
+        std::vector<int> search(pmc::pmc_graph &G, int lower_bound);
+
+
         Graph graph_;
         Params params_;
     };
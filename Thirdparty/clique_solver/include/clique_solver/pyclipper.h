@@ -37,6 +37,7 @@ namespace clipper{
         std::vector<Solution> solns_; ///< solution information from CLIPPERPyramid clique solver
         std::vector<clique_solver::SpAffinity> vM_; ///< affinity matrix vector
         std::vector<clique_solver::SpConstraint> vC_; ///< constraint matrix vector
+        std::vector<CSRAffinity> vcsr_; ///< CSR of each graph if params.use_csr, empty otherwise
         int num_graphs_;
     };
 }
@@ -0,0 +1,213 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#include "clique_solver/bitset_clique.h"
+#include <algorithm>
+
+namespace clique_solver {
+
+    namespace {
+        inline int popcount(uint64_t word) { return __builtin_popcountll(word); }
+
+        inline int lowestBit(uint64_t word) { return __builtin_ctzll(word); }
+    }
+
+    void BitsetCliqueSolver::coreNumbers(const std::vector<long long> &offsets, const std::vector<int> &neighbors,
+                                         std::vector<int> *cores, std::vector<int> *order) {
+        const int n = offsets.size() - 1;
+        std::vector<int> &degree = *cores, &vert = *order;
+        degree.resize(n);
+        int max_degree = 0;
+        for (int v = 0; v < n; ++v) {
+            degree[v] = offsets[v + 1] - offsets[v];
+            max_degree = std::max(max_degree, degree[v]);
+        }
+        // vertices sorted by degree with the start of each degree bin, then peeled in that order
+        std::vector<int> bin(max_degree + 1, 0), pos(n);
+        vert.resize(n);
+        for (int v = 0; v < n; ++v) {
+            bin[degree[v]]++;
+        }
+        for (int d = 0, start = 0; d <= max_degree; ++d) {
+            int count = bin[d];
+            bin[d] = start;
+            start += count;
+        }
+        for (int v = 0; v < n; ++v) {
+            pos[v] = bin[degree[v]]++;
+            vert[pos[v]] = v;
+        }
+        for (int d = max_degree; d > 0; --d) {
+            bin[d] = bin[d - 1];
+        }
+        bin[0] = 0;
+        for (int i = 0; i < n; ++i) {
+            const int v = vert[i];
+            for (long long j = offsets[v]; j < offsets[v + 1]; ++j) {
+                const int u = neighbors[j];
+                if (degree[u] > degree[v]) {
+                    // move u to the front of its bin, then into the bin below
+                    const int du = degree[u], pu = pos[u], pw = bin[du], w = vert[pw];
+                    if (u != w) {
+                        pos[u] = pw;
+                        vert[pu] = w;
+                        pos[w] = pu;
+                        vert[pw] = u;
+                    }
+                    bin[du]++;
+                    degree[u]--;
+                }
+            }
+        }
+    }
+
+    std::vector<int> BitsetCliqueSolver::solve(const std::vector<long long> &offsets,
+                                               const std::vector<int> &neighbors, int lower_bound,
+                                               double time_limit) {
+        num_branches_ = 0;
+        timed_out_ = false;
+        best_.clear();
+        clique_.clear();
+        best_size_ = std::max(lower_bound, 0);
+        deadline_ = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(time_limit));
+        if (offsets.size() < 2) {
+            return {};
+        }
+
+        // a vertex of a clique larger than best_size_ has a core number of at least best_size_; the survivors
+        // are numbered from the highest core down, so the greedy coloring starts from the densest part
+        std::vector<int> cores, peel_order;
+        coreNumbers(offsets, neighbors, &cores, &peel_order);
+        vertices_.clear();
+        int max_core = 0;
+        for (auto it = peel_order.rbegin(); it != peel_order.rend(); ++it) {
+            if (cores[*it] >= best_size_) {
+                vertices_.push_back(*it);
+                max_core = std::max(max_core, cores[*it]);
+            }
+        }
+        num_vertices_ = vertices_.size();
+        if (num_vertices_ == 0) {
+            return {};
+        }
+        std::vector<int> old_to_new(offsets.size() - 1, -1);
+        for (int v = 0; v < num_vertices_; ++v) {
+            old_to_new[vertices_[v]] = v;
+        }
+
+        num_words_ = (num_vertices_ + 63) / 64;
+        adj_.assign(size_t(num_vertices_) * num_words_, 0);
+        for (int v = 0; v < num_vertices_; ++v) {
+            uint64_t *r = &adj_[size_t(v) * num_words_];
+            for (long long j = offsets[vertices_[v]]; j < offsets[vertices_[v] + 1]; ++j) {
+                const int u = old_to_new[neighbors[j]];
+                if (u >= 0) {
+                    r[u >> 6] |= uint64_t(1) << (u & 63);
+                }
+            }
+        }
+
+        // a clique has at most max_core + 1 vertices, one depth per vertex and one for the empty candidates
+        const int max_depth = max_core + 3;
+        candidates_.assign(size_t(max_depth) * num_words_, 0);
+        uncolored_.resize(num_words_);
+        color_class_.resize(num_words_);
+        order_.resize(max_depth);
+        colors_.resize(max_depth);
+        uint64_t *all = candidates(0);
+        for (int v = 0; v < num_vertices_; ++v) {
+            all[v >> 6] |= uint64_t(1) << (v & 63);
+        }
+        expand(0);
+
+        std::vector<int> clique;
+        clique.reserve(best_.size());
+        for (int v: best_) {
+            clique.push_back(vertices_[v]);
+        }
+        std::sort(clique.begin(), clique.end());
+        return clique;
+    }
+
+    void BitsetCliqueSolver::color(int depth, int k_min) {
+        std::vector<int> &order = order_[depth], &colors = colors_[depth];
+        order.clear();
+        colors.clear();
+        const uint64_t *P = candidates(depth);
+        int remaining = 0;
+        for (int w = 0; w < num_words_; ++w) {
+            uncolored_[w] = P[w];
+            remaining += popcount(P[w]);
+        }
+        // each color class is an independent set taken greedily in vertex order
+        for (int k = 1; remaining > 0; ++k) {
+            std::copy(uncolored_.begin(), uncolored_.end(), color_class_.begin());
+            for (int w = 0; w < num_words_; ++w) {
+                while (color_class_[w]) {
+                    const int bit = lowestBit(color_class_[w]);
+                    const int v = (w << 6) + bit;
+                    const uint64_t mask = ~(uint64_t(1) << bit);
+                    color_class_[w] &= mask;
+                    uncolored_[w] &= mask;
+                    remaining--;
+                    const uint64_t *r = row(v);
+                    for (int x = w; x < num_words_; ++x) {
+                        color_class_[x] &= ~r[x];
+                    }
+                    if (k >= k_min) {
+                        order.push_back(v);
+                        colors.push_back(k);
+                    }
+                }
+            }
+        }
+    }
+
+    void BitsetCliqueSolver::expand(int depth) {
+        if ((++num_branches_ & 1023) == 0 && std::chrono::steady_clock::now() > deadline_) {
+            timed_out_ = true;
+        }
+        if (timed_out_) {
+            return;
+        }
+        uint64_t *P = candidates(depth);
+        int size = 0;
+        for (int w = 0; w < num_words_; ++w) {
+            size += popcount(P[w]);
+        }
+        if (int(clique_.size()) + size <= best_size_) {
+            return;
+        }
+
+        // only vertices whose color can lift the clique above the best one are branched on
+        color(depth, best_size_ - int(clique_.size()) + 1);
+        const std::vector<int> &order = order_[depth], &colors = colors_[depth];
+        uint64_t *next = candidates(depth + 1);
+        for (int i = int(order.size()) - 1; i >= 0 && !timed_out_; --i) {
+            if (int(clique_.size()) + colors[i] <= best_size_) {
+                return;
+            }
+            const int v = order[i];
+            const uint64_t *r = row(v);
+            uint64_t any = 0;
+            for (int w = 0; w < num_words_; ++w) {
+                next[w] = P[w] & r[w];
+                any |= next[w];
+            }
+            clique_.push_back(v);
+            if (any) {
+                expand(depth + 1);
+            } else if (int(clique_.size()) > best_size_) {
+                best_ = clique_;
+                best_size_ = best_.size();
+            }
+            clique_.pop_back();
+            P[v >> 6] &= ~(uint64_t(1) << (v & 63));
+        }
+    }
+}
@@ -13,7 +13,20 @@ namespace clipper {
 
     CLIPPER::CLIPPER(const clique_solver::Graph &graph, const Params &params)
             : params_(params) {
-        setSparseMatrixData(graph.affinity(), graph.constraint());
+        setGraph(graph);
+    }
+
+    // ----------------------------------------------------------------------------
+
+    void CLIPPER::setGraph(const clique_solver::Graph &graph) {
+        if (params_.use_csr) {
+            graph.toCSR(&csr_.offsets, &csr_.neighbors);
+            csr_.weights.clear();
+            M_ = SpAffinity();
+            C_ = SpConstraint();
+        } else {
+            setSparseMatrixData(graph.affinity(), graph.constraint());
+        }
     }
 
     // ----------------------------------------------------------------------------
@@ -21,7 +34,7 @@ namespace clipper {
     void CLIPPER::solve(const Eigen::VectorXd &_u0) {
         Eigen::VectorXd u0;
         if (_u0.size() == 0) {
-            u0 = randvec(M_.cols());
+            u0 = randvec(csr_.offsets.empty() ? M_.cols() : csr_.offsets.size() - 1);
         } else {
             u0 = _u0;
         }
@@ -38,8 +51,7 @@ namespace clipper {
         // Initialization
         //
 
-        const size_t n = M_.cols();
-        const Eigen::VectorXd ones = Eigen::VectorXd::Ones(n);
+        const size_t n = u0.size();
 
         // initialize memory
         Eigen::VectorXd gradF(n);
@@ -52,7 +64,7 @@ namespace clipper {
 
         // one step of power method to have a good scaling of u
         if (params_.rescale_u0) {
-            u = M_.selfadjointView<Eigen::Upper>() * u0 + u0;
+            penaltyTerms(M_, C_, csr_, u0, &u, nullptr);
         } else {
             u = u0;
         }
@@ -60,10 +72,10 @@ namespace clipper {
 
         // initial value of d
         double d = 0; // zero if there are no active constraints
-        Eigen::VectorXd Cbu = ones * u.sum() - C_.selfadjointView<Eigen::Upper>() * u - u;
+        Eigen::VectorXd Cbu(n);
+        penaltyTerms(M_, C_, csr_, u, &Mu, &Cbu);
         const Eigen::VectorXi idxD = ((Cbu.array() > params_.eps) && (u.array() > params_.eps)).cast<int>();
         if (idxD.sum() > 0) {
-            Mu = M_.selfadjointView<Eigen::Upper>() * u + u;
             num = selectFromIndicator(Mu, idxD);
             den = selectFromIndicator(Cbu, idxD);
             d = (num.array() / den.array()).mean();
@@ -77,8 +89,7 @@ namespace clipper {
 
         size_t i, j, k; // iteration counters
         for (i = 0; i < params_.maxoliters; ++i) {
-            gradF = (1 + d) * u - d * ones * u.sum() + M_.selfadjointView<Eigen::Upper>() * u +
-                    C_.selfadjointView<Eigen::Upper>() * u * d;
+            gradient(M_, C_, csr_, u, d, &gradF);
             F = u.dot(gradF); // current objective value
 
             //
@@ -97,10 +108,7 @@ namespace clipper {
                     unew = u + alpha * gradF;                     // gradient step
                     unew = unew.cwiseMax(0);                      // project onto positive orthant
                     unew.normalize();                             // project onto S^n
-                    gradFnew = (1 + d) * unew // because M/C is missing identity on diagonal
-                               - d * ones * unew.sum()
-                               + M_.selfadjointView<Eigen::Upper>() * unew
-                               + C_.selfadjointView<Eigen::Upper>() * unew * d;
+                    gradient(M_, C_, csr_, unew, d, &gradFnew);
                     Fnew = unew.dot(gradFnew);                    // new objective value after step
 
                     deltaF = Fnew - F;                            // change in objective value
@@ -127,10 +135,9 @@ namespace clipper {
             // Increase d
             //
 
-            Cbu = ones * u.sum() - C_.selfadjointView<Eigen::Upper>() * u - u;
+            penaltyTerms(M_, C_, csr_, u, &Mu, &Cbu);
             const Eigen::VectorXi idxD = ((Cbu.array() > params_.eps) && (u.array() > params_.eps)).cast<int>();
             if (idxD.sum() > 0) {
-                Mu = M_.selfadjointView<Eigen::Upper>() * u + u;
                 num = selectFromIndicator(Mu, idxD);
                 den = selectFromIndicator(Cbu, idxD);
                 const double deltad = (num.array() / den.array()).abs().mean();
@@ -160,6 +167,16 @@ namespace clipper {
     // ----------------------------------------------------------------------------
 
     Affinity CLIPPER::getAffinityMatrix() {
+        if (!csr_.offsets.empty()) {
+            const int n = csr_.offsets.size() - 1;
+            Affinity M = Affinity::Identity(n, n);
+            for (int i = 0; i < n; ++i) {
+                for (long long j = csr_.offsets[i]; j < csr_.offsets[i + 1]; ++j) {
+                    M(i, csr_.neighbors[j]) = csr_.weights.empty() ? 1.0 : csr_.weights[j];
+                }
+            }
+            return M;
+        }
         Affinity M = SpAffinity(M_.selfadjointView<Eigen::Upper>())
                      + Affinity::Identity(M_.rows(), M_.cols());
         return M;
@@ -168,6 +185,16 @@ namespace clipper {
     // ----------------------------------------------------------------------------
 
     Constraint CLIPPER::getConstraintMatrix() {
+        if (!csr_.offsets.empty()) {
+            const int n = csr_.offsets.size() - 1;
+            Constraint C = Constraint::Identity(n, n);
+            for (int i = 0; i < n; ++i) {
+                for (long long j = csr_.offsets[i]; j < csr_.offsets[i + 1]; ++j) {
+                    C(i, csr_.neighbors[j]) = 1.0;
+                }
+            }
+            return C;
+        }
         Constraint C = SpConstraint(C_.selfadjointView<Eigen::Upper>())
                        + Constraint::Identity(C_.rows(), C_.cols());
         return C;
@@ -178,6 +205,92 @@ namespace clipper {
     void CLIPPER::setSparseMatrixData(const SpAffinity &M, const SpConstraint &C) {
         M_ = M;
         C_ = C;
+        csr_ = CSRAffinity();
+    }
+
+    // ----------------------------------------------------------------------------
+
+    void CLIPPER::setCSRData(CSRAffinity csr) {
+        csr_ = std::move(csr);
+        M_ = SpAffinity();
+        C_ = SpConstraint();
+    }
+
+    // ----------------------------------------------------------------------------
+
+    void CLIPPER::gradient(const SpAffinity &M, const SpConstraint &C, const CSRAffinity &csr,
+                           const Eigen::VectorXd &u, double d, Eigen::VectorXd *grad) const {
+        const int n = u.size();
+        const double sum = u.sum();
+        if (csr.offsets.empty()) {
+            *grad = (1 + d) * u // because M/C is missing identity on diagonal
+                    - Eigen::VectorXd::Constant(n, d * sum)
+                    + M.selfadjointView<Eigen::Upper>() * u
+                    + C.selfadjointView<Eigen::Upper>() * u * d;
+            return;
+        }
+        // rows are independent, (M + d C) u is one pass over the shared pattern
+        grad->resize(n);
+        const long long *offsets = csr.offsets.data();
+        const int *neighbors = csr.neighbors.data();
+        const double *weights = csr.weights.empty() ? nullptr : csr.weights.data();
+        const double *x = u.data();
+        double *g = grad->data();
+#pragma omp parallel for if(parallelize_) schedule(dynamic, 256) default(none) \
+        shared(n, sum, d, offsets, neighbors, weights, x, g)
+        for (int i = 0; i < n; ++i) {
+            double s = 0;
+            if (weights) {
+                for (long long j = offsets[i]; j < offsets[i + 1]; ++j) {
+                    s += (weights[j] + d) * x[neighbors[j]];
+                }
+            } else {
+                for (long long j = offsets[i]; j < offsets[i + 1]; ++j) {
+                    s += x[neighbors[j]];
+                }
+                s *= 1 + d;
+            }
+            g[i] = (1 + d) * x[i] - d * sum + s;
+        }
+    }
+
+    // ----------------------------------------------------------------------------
+
+    void CLIPPER::penaltyTerms(const SpAffinity &M, const SpConstraint &C, const CSRAffinity &csr,
+                               const Eigen::VectorXd &u, Eigen::VectorXd *Mu, Eigen::VectorXd *Cbu) const {
+        const int n = u.size();
+        const double sum = u.sum();
+        if (csr.offsets.empty()) {
+            *Mu = M.selfadjointView<Eigen::Upper>() * u + u;
+            if (Cbu) {
+                *Cbu = Eigen::VectorXd::Constant(n, sum) - C.selfadjointView<Eigen::Upper>() * u - u;
+            }
+            return;
+        }
+        Mu->resize(n);
+        if (Cbu) {
+            Cbu->resize(n);
+        }
+        const long long *offsets = csr.offsets.data();
+        const int *neighbors = csr.neighbors.data();
+        const double *weights = csr.weights.empty() ? nullptr : csr.weights.data();
+        const double *x = u.data();
+        double *mu = Mu->data(), *cbu = Cbu ? Cbu->data() : nullptr;
+#pragma omp parallel for if(parallelize_) schedule(dynamic, 256) default(none) \
+        shared(n, sum, offsets, neighbors, weights, x, mu, cbu)
+        for (int i = 0; i < n; ++i) {
+            double c = 0, m = 0;
+            for (long long j = offsets[i]; j < offsets[i + 1]; ++j) {
+                c += x[neighbors[j]];
+                if (weights) {
+                    m += weights[j] * x[neighbors[j]];
+                }
+            }
+            mu[i] = (weights ? m : c) + x[i];
+            if (cbu) {
+                cbu[i] = sum - c - x[i];
+            }
+        }
     }
 
 
@@ -9,39 +9,41 @@
 #include "clique_solver/graph.h"
 #include "pmc/pmc.h"
 #include "clique_solver/pmc_solver.h"
+#include "clique_solver/bitset_clique.h"
 #include <chrono>
 
 namespace clique_solver {
 
-    vector<int> clique_solver::MaxCliqueSolver::findMaxClique(clique_solver::Graph graph, int lower_bound) {
+    vector<int> clique_solver::MaxCliqueSolver::findMaxClique(const clique_solver::Graph &graph, int lower_bound) {
+        vector<long long> vertices;
+        vector<int> edges;
+        graph.toCSR(&vertices, &edges);
+        return findMaxClique(vertices, edges, lower_bound);
+    }
+
+    vector<int> clique_solver::MaxCliqueSolver::findMaxClique(vector<long long> &offsets, vector<int> &neighbors,
+                                                              int lower_bound) {
+        // Adopt the CSR buffers in a PMC graph, and give them back for reuse
+        pmc::pmc_graph G(std::move(offsets), std::move(neighbors)); // typically takes 0.005 ms
+        vector<int> C = search(G, lower_bound);
+        G.release(offsets, neighbors);
+        return C;
+    }
 
+    vector<int> clique_solver::MaxCliqueSolver::search(pmc::pmc_graph &G, int lower_bound) {
         // Handle deprecated field
         if (!params_.solve_exactly) {
             params_.solver_mode = CLIQUE_SOLVER_MODE::PMC_HEU;
         }
+        int num_vertices = G.num_vertices();
 
-        // Create a PMC graph from the TEASER graph
-        int num_vertices = graph.numVertices();
-        vector<int> edges;
-        edges.reserve(graph.numEdges() * 2);
-        vector<long long> vertices;
-        vertices.reserve(num_vertices + 1);
-
-        vertices.push_back(0);
-        for (size_t i = 0; i < num_vertices; ++i) {
-            const auto &c_edges = graph.getEdges(i);
-            edges.insert(edges.end(), c_edges.begin(), c_edges.end());
-            vertices.push_back(edges.size());
-        }
-
-        // Use PMC to calculate
-        pmc::pmc_graph G(vertices, edges); // typically takes 0.005 ms
         // upper-bound of max clique
         G.compute_cores();
         int max_core = G.get_max_core(); // typically takes 0.040 ms, get the upper bound of clique size
 
         vector<int> C; // vector to represent max clique
-        if (params_.solver_mode == CLIQUE_SOLVER_MODE::PMC_EXACT){
+        if (params_.solver_mode == CLIQUE_SOLVER_MODE::PMC_EXACT ||
+            params_.solver_mode == CLIQUE_SOLVER_MODE::BITSET){
             pmc::input in; // use default input
             in.time_limit = params_.time_limit;
             in.threads = 12;
@@ -59,7 +61,17 @@ namespace clique_solver {
 
             if (in.lb == in.ub) return C;
 
-            if (G.num_vertices() < in.adj_limit) {
+            bool use_bitset = params_.solver_mode == CLIQUE_SOLVER_MODE::BITSET ||
+                              (params_.auto_bitset && G.density() >= params_.bitset_density_threshold &&
+                               G.num_vertices() <= params_.bitset_max_vertices);
+            if (use_bitset) {
+                // dense graph: bit-parallel coloring bounds, keeps the heuristic clique if nothing is larger
+                BitsetCliqueSolver finder;
+                vector<int> clique = finder.solve(*G.get_vertices(), *G.get_edges(), in.lb, params_.time_limit);
+                if (!clique.empty()) {
+                    C = std::move(clique);
+                }
+            } else if (G.num_vertices() < in.adj_limit) {
                 G.create_adj();
                 pmc::pmcx_maxclique finder(G, in);
                 finder.search_dense(G, C);
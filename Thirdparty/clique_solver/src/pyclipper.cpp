@@ -16,9 +16,14 @@ namespace clipper {
         num_graphs_ = graphs.size();
         vM_.resize(num_graphs_);
         vC_.resize(num_graphs_);
+        vcsr_.resize(num_graphs_);
         for (size_t i = 0; i < num_graphs_; ++i) {
-            vM_[i] = graphs[i].affinity();
-            vC_[i] = graphs[i].constraint();
+            if (params_.use_csr) {
+                graphs[i].toCSR(&vcsr_[i].offsets, &vcsr_[i].neighbors);
+            } else {
+                vM_[i] = graphs[i].affinity();
+                vC_[i] = graphs[i].constraint();
+            }
         }
     }
 
@@ -27,7 +32,7 @@ namespace clipper {
     void PyCLIPPER::solve(const Eigen::VectorXd &_u0) {
         Eigen::VectorXd u0;
         if (_u0.size() == 0) {
-            u0 = randvec(vM_[0].cols());
+            u0 = randvec(params_.use_csr ? vcsr_[0].offsets.size() - 1 : vM_[0].cols());
         } else {
             u0 = _u0;
         }
@@ -39,8 +44,7 @@ namespace clipper {
 
         // Initialization
 
-        const size_t n = vM_[0].cols();
-        const Eigen::VectorXd ones = Eigen::VectorXd::Ones(n);
+        const size_t n = u0.size();
 
         // initialize memory
         Eigen::VectorXd gradF(n);
@@ -53,17 +57,17 @@ namespace clipper {
 
         // one step of power method to have a good scaling of u
         if (params_.rescale_u0) {
-            u = vM_[0].selfadjointView<Eigen::Upper>() * u0 + u0;
+            penaltyTerms(vM_[0], vC_[0], vcsr_[0], u0, &u, nullptr);
         } else {
             u = u0;
         }
         u /= u.norm();
         // initial value of d
         double d = 0; // zero if there are no active constraints
-        Eigen::VectorXd Cbu = ones * u.sum() - vC_[0].selfadjointView<Eigen::Upper>() * u - u;
+        Eigen::VectorXd Cbu(n);
+        penaltyTerms(vM_[0], vC_[0], vcsr_[0], u, &Mu, &Cbu);
         const Eigen::VectorXi idxD = ((Cbu.array() > params_.eps) && (u.array() > params_.eps)).cast<int>();
         if (idxD.sum() > 0) {
-            Mu = vM_[0].selfadjointView<Eigen::Upper>() * u + u;
             num = selectFromIndicator(Mu, idxD);
             den = selectFromIndicator(Cbu, idxD);
             d = (num.array() / den.array()).mean();
@@ -79,9 +83,9 @@ namespace clipper {
 
             const SpAffinity &M_ = vM_[relax];
             const SpConstraint &C_ = vC_[relax];
+            const CSRAffinity &csr_ = vcsr_[relax];
 
-            gradF = (1 + d) * u - d * ones * u.sum() + M_.selfadjointView<Eigen::Upper>() * u +
-                    C_.selfadjointView<Eigen::Upper>() * u * d;
+            gradient(M_, C_, csr_, u, d, &gradF);
             F = u.dot(gradF); // current objective value
 
             // Orthogonal projected gradient ascent
@@ -94,10 +98,7 @@ namespace clipper {
                     unew = u + alpha * gradF;                     // gradient step
                     unew = unew.cwiseMax(0);                      // project onto positive orthant
                     unew.normalize();                             // project onto S^n
-                    gradFnew = (1 + d) * unew // because M/C is missing identity on diagonal
-                               - d * ones * unew.sum()
-                               + M_.selfadjointView<Eigen::Upper>() * unew
-                               + C_.selfadjointView<Eigen::Upper>() * unew * d;
+                    gradient(M_, C_, csr_, unew, d, &gradFnew);
                     Fnew = unew.dot(gradFnew);                    // new objective value after step
 
                     deltaF = Fnew - F;                            // change in objective value
@@ -124,10 +125,9 @@ namespace clipper {
             // Increase d
             //
 
-            Cbu = ones * u.sum() - C_.selfadjointView<Eigen::Upper>() * u - u;
+            penaltyTerms(M_, C_, csr_, u, &Mu, &Cbu);
             const Eigen::VectorXi idxD = ((Cbu.array() > params_.eps) && (u.array() > params_.eps)).cast<int>();
             if (idxD.sum() > 0) {
-                Mu = M_.selfadjointView<Eigen::Upper>() * u + u;
                 num = selectFromIndicator(Mu, idxD);
                 den = selectFromIndicator(Cbu, idxD);
                 const double deltad = (num.array() / den.array()).abs().mean();
@@ -1,2 +0,0 @@
-find_package(igraph 0.9.9 REQUIRED)
-list(APPEND ALL_TARGET_LIBRARIES igraph::igraph)
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include "utils/config.h"
+#include "utils/synthetic.h"
+#include "utils/memory.h"
+#include "back_end/reglib.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+using namespace g3reg;
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: backend_scaling_bench config_file [outlier_ratio] [max_corrs] [time_budget_s]"
+                  << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    double outlier_ratio = argc > 2 ? std::stod(argv[2]) : 0.9;
+    int max_corrs = argc > 3 ? std::stoi(argv[3]) : 20000;
+    double time_budget = argc > 4 ? std::stod(argv[4]) : 60;
+    double budget_ms = time_budget * 1e3;
+    InitGLOG(config_path, nullptr);
+    config.load_config(config_path);
+
+    SyntheticScene scene;
+    pcl::PointCloud<pcl::PointXYZ>::Ptr src_cloud = scene.scan(StreetPose(0, 0, 0));
+    PointRows src_points(src_cloud->size(), 3);
+    for (size_t i = 0; i < src_cloud->size(); i++) {
+        src_points.row(i) << src_cloud->points[i].x, src_cloud->points[i].y, src_cloud->points[i].z;
+    }
+
+    std::vector<int> sweep;
+    for (int n: {100, 200, 500, 1000, 2000, 5000, 10000, 20000}) {
+        if (n <= max_corrs) {
+            sweep.push_back(n);
+        }
+    }
+    // ransac_preemptive is the RANSAC back end with ransac/scoring preemptive, ransac the one with full scoring
+    std::vector<std::string> back_ends = {"pagor", "3dmac", "ransac", "ransac_preemptive"};
+    std::map<std::string, bool> over_budget;
+    std::string csv_path = config.log_dir + "/backend_scaling.csv";
+    std::ofstream csv(csv_path);
+    csv << "back_end,num_corrs,outlier_ratio,time_ms,graph_ms,clique_ms,tf_solver_ms,peak_rss_mb,rot_err_deg,"
+           "trans_err_m\n";
+    LOG(INFO) << "back_end num_corrs time_ms peak_rss_mb rot_err_deg trans_err_m";
+    for (int num_corrs: sweep) {
+        CorrespondenceParams corr_params;
+        corr_params.seed = num_corrs;
+        corr_params.num_corrs = num_corrs;
+        corr_params.outlier_ratio = outlier_ratio;
+        pcl::PointCloud<pcl::PointXYZ> tgt_cloud;
+        SyntheticCorrespondences corrs = GenerateCorrespondences(*src_cloud, corr_params, &tgt_cloud);
+        PointRows tgt_points(tgt_cloud.size(), 3);
+        for (size_t i = 0; i < tgt_cloud.size(); i++) {
+            tgt_points.row(i) << tgt_cloud.points[i].x, tgt_cloud.points[i].y, tgt_cloud.points[i].z;
+        }
+
+        for (const auto &back_end: back_ends) {
+            if (over_budget[back_end]) {
+                continue;
+            }
+            Config run_config = config;
+            run_config.back_end = back_end;
+            if (back_end == "ransac" || back_end == "ransac_preemptive") {
+                run_config.back_end = "ransac";
+                run_config.ransac_scoring = back_end == "ransac" ? "full" : "preemptive";
+            }
+            // the 3DMAC clique search stops at the budget, so that one dense graph cannot block the sweep
+            if (back_end == "3dmac" && (run_config.mac_time_limit <= 0 || run_config.mac_time_limit > budget_ms)) {
+                run_config.mac_time_limit = budget_ms;
+            }
+            double rss_before = CurrentRssMb();
+            ResetPeakRss();
+            robot_utils::TicToc timer;
+            FRGresult result = SolveFromCorresp(corrs.src, corrs.tgt, src_points, tgt_points, run_config);
+            double time_ms = timer.toc();
+            double peak_mb = PeakRssMb() - rss_before;
+
+            Eigen::Matrix4d err = corrs.T.inverse() * result.tf;
+            double rot_err = std::acos(std::min(1.0, std::max(-1.0, (err.block<3, 3>(0, 0).trace() - 1) / 2))) *
+                             180.0 / M_PI;
+            double trans_err = err.block<3, 1>(0, 3).norm();
+            csv << back_end << "," << num_corrs << "," << outlier_ratio << "," << time_ms << "," << result.graph_time
+                << "," << result.clique_time << "," << result.tf_solver_time << "," << peak_mb << "," << rot_err
+                << "," << trans_err << "\n";
+            LOG(INFO) << std::fixed << std::setprecision(3) << back_end << " " << num_corrs << " " << time_ms << " "
+                      << peak_mb << " " << rot_err << " " << trans_err;
+            // the larger sizes would only take longer, a run stopped at the budget counts as over it
+            over_budget[back_end] = time_ms >= budget_ms;
+        }
+    }
+    LOG(INFO) << "Results saved to " << csv_path;
+    return 0;
+}
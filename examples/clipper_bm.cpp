@@ -0,0 +1,149 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "clique_solver/clipper.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+
+/**
+ * Pyramid of compatibility graphs over the same correspondences: a clique of inliers planted among vertices connected
+ * with probability densities[level]. Levels are nested, as the graphs of growing noise bounds.
+ */
+std::vector<std::vector<std::pair<int, int>>> PyramidEdges(int num_vertices, const std::vector<double> &densities,
+                                                          int num_inliers, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::vector<int> order(num_vertices);
+    for (int i = 0; i < num_vertices; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<char> inlier(num_vertices, 0);
+    for (int i = 0; i < num_inliers; i++) {
+        inlier[order[i]] = 1;
+    }
+    std::vector<std::vector<std::pair<int, int>>> edges(densities.size());
+    for (int i = 0; i < num_vertices; i++) {
+        for (int j = i + 1; j < num_vertices; j++) {
+            const double r = unit(rng);
+            for (size_t level = 0; level < densities.size(); level++) {
+                if ((inlier[i] && inlier[j]) || r < densities[level]) {
+                    edges[level].emplace_back(i, j);
+                }
+            }
+        }
+    }
+    return edges;
+}
+
+clique_solver::Graph BuildGraph(int num_vertices, const std::vector<std::pair<int, int>> &edges, bool dense) {
+    clique_solver::Graph graph;
+    graph.setType(dense);
+    graph.populateVertices(num_vertices);
+    for (const auto &e: edges) {
+        graph.addEdge(e.first, e.second);
+    }
+    graph.initAffinityMatrix();
+    return graph;
+}
+
+struct PathStats {
+    double build_ms = 0, solve_ms = 0;
+    size_t bytes = 0;
+    int iters = 0;
+};
+
+/**
+ * CLIPPER on the dense path (adjacency matrix of the graph, affinity and constraint taken from it as sparse
+ * matrices, serial products) against the CSR path (M and C as one CSR from the graph edges, row-parallel products),
+ * both from the same random vector on every level. The CSR path is also run with each level started from the
+ * solution of the previous one. Both paths compute the same iterations, so they must select the same vertices.
+ */
+int main(int argc, char **argv) {
+    int max_vertices = argc > 1 ? std::stoi(argv[1]) : 4000;
+    int num_inliers = argc > 2 ? std::stoi(argv[2]) : 50;
+    const std::vector<double> densities = {0.01, 0.02, 0.05, 0.1};
+
+    clipper::Params dense_params;
+    clipper::Params csr_params = dense_params;
+    csr_params.use_csr = true;
+
+    int mismatches = 0;
+    std::cout << std::left << std::setw(7) << "V" << std::setw(7) << "level" << std::right << std::setw(10) << "edges"
+              << std::setw(11) << "dense_MB" << std::setw(9) << "csr_MB" << std::setw(10) << "build_ms"
+              << std::setw(11) << "csr_build" << std::setw(10) << "solve_ms" << std::setw(11) << "csr_solve"
+              << std::setw(10) << "warm_ms" << std::setw(7) << "iters" << std::setw(6) << "warm" << std::setw(8)
+              << "found" << std::setw(8) << "equal" << std::endl;
+    for (int num_vertices: {1000, 2000, 4000, 8000}) {
+        if (num_vertices > max_vertices) {
+            continue;
+        }
+        auto edges = PyramidEdges(num_vertices, densities, num_inliers, num_vertices);
+        const Eigen::VectorXd u0 = Eigen::VectorXd::NullaryExpr(num_vertices, [] {
+            static std::mt19937 rng(0);
+            return std::uniform_real_distribution<double>(0, 1)(rng);
+        });
+        Eigen::VectorXd warm_u0;
+        for (size_t level = 0; level < densities.size(); level++) {
+            PathStats dense, csr, warm;
+            std::vector<int> dense_nodes, csr_nodes;
+            {
+                robot_utils::TicToc build_timer;
+                clique_solver::Graph graph = BuildGraph(num_vertices, edges[level], true);
+                clipper::CLIPPER solver(graph, dense_params);
+                dense.build_ms = build_timer.toc();
+                // adjacency matrix of the graph, plus M and C as compressed columns
+                const size_t nnz = graph.affinity().nonZeros();
+                dense.bytes = size_t(num_vertices) * num_vertices * sizeof(double) +
+                              2 * (nnz * (sizeof(double) + sizeof(int)) + (num_vertices + 1) * sizeof(int));
+                robot_utils::TicToc solve_timer;
+                solver.solve(u0);
+                dense.solve_ms = solve_timer.toc();
+                dense.iters = solver.getSolution().ifinal;
+                dense_nodes = solver.getSolution().nodes;
+            }
+            {
+                robot_utils::TicToc build_timer;
+                clique_solver::Graph graph = BuildGraph(num_vertices, edges[level], false);
+                clipper::CSRAffinity affinity;
+                graph.toCSR(&affinity.offsets, &affinity.neighbors);
+                csr.bytes = affinity.bytes();
+                clipper::CLIPPER solver(csr_params);
+                solver.setCSRData(std::move(affinity));
+                csr.build_ms = build_timer.toc();
+                robot_utils::TicToc solve_timer;
+                solver.solve(u0);
+                csr.solve_ms = solve_timer.toc();
+                csr.iters = solver.getSolution().ifinal;
+                csr_nodes = solver.getSolution().nodes;
+
+                robot_utils::TicToc warm_timer;
+                solver.solve(level == 0 ? u0 : warm_u0);
+                warm.solve_ms = warm_timer.toc();
+                warm.iters = solver.getSolution().ifinal;
+                warm_u0 = solver.getSolution().u;
+            }
+            std::sort(dense_nodes.begin(), dense_nodes.end());
+            std::sort(csr_nodes.begin(), csr_nodes.end());
+            bool equal = dense_nodes == csr_nodes;
+            mismatches += !equal;
+
+            std::cout << std::left << std::setw(7) << num_vertices << std::setw(7) << level << std::right
+                      << std::setw(10) << edges[level].size() << std::fixed << std::setprecision(2) << std::setw(11)
+                      << dense.bytes / 1048576.0 << std::setw(9) << csr.bytes / 1048576.0 << std::setprecision(1)
+                      << std::setw(10) << dense.build_ms << std::setw(11) << csr.build_ms << std::setw(10)
+                      << dense.solve_ms << std::setw(11) << csr.solve_ms << std::setw(10) << warm.solve_ms
+                      << std::setw(7) << csr.iters << std::setw(6) << warm.iters << std::setw(8) << csr_nodes.size()
+                      << std::setw(8) << (equal ? "yes" : "NO") << std::endl;
+        }
+    }
+    if (mismatches > 0) {
+        std::cout << mismatches << " graphs where the dense and CSR paths differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <sstream>
+#include "clique_solver/pmc_solver.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+
+/**
+ * Compatibility graph of a registration problem: a clique of inliers planted among vertices connected with
+ * probability density, in random order.
+ */
+clique_solver::Graph CompatibilityGraph(int num_vertices, double density, int num_inliers, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::vector<int> order(num_vertices);
+    for (int i = 0; i < num_vertices; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<char> inlier(num_vertices, 0);
+    for (int i = 0; i < num_inliers; i++) {
+        inlier[order[i]] = 1;
+    }
+    std::map<int, std::vector<int>> adj_list;
+    for (int i = 0; i < num_vertices; i++) {
+        adj_list[i];
+        for (int j = i + 1; j < num_vertices; j++) {
+            if ((inlier[i] && inlier[j]) || unit(rng) < density) {
+                adj_list[i].push_back(j);
+                adj_list[j].push_back(i);
+            }
+        }
+    }
+    return clique_solver::Graph(adj_list);
+}
+
+bool IsClique(clique_solver::Graph &graph, const std::vector<int> &clique) {
+    for (size_t i = 0; i < clique.size(); i++) {
+        for (size_t j = i + 1; j < clique.size(); j++) {
+            if (!graph.hasEdge(clique[i], clique[j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// best time in ms of repeats solves, and the clique of the last one
+double Best(const clique_solver::MaxCliqueSolver::Params &params, const clique_solver::Graph &graph, int repeats,
+            std::vector<int> *clique) {
+    double best = INFINITY;
+    for (int i = 0; i < repeats; i++) {
+        clique_solver::MaxCliqueSolver solver(params);
+        robot_utils::TicToc timer;
+        *clique = solver.findMaxClique(graph);
+        best = std::min(best, timer.toc());
+    }
+    return best;
+}
+
+/**
+ * PMC against the bit-parallel coloring solver (BITSET mode) on compatibility graphs from sparse to dense. Both
+ * are exact, so they must return cliques of the same size.
+ */
+int main(int argc, char **argv) {
+    int repeats = argc > 1 ? std::stoi(argv[1]) : 3;
+    int num_inliers = argc > 2 ? std::stoi(argv[2]) : 40;
+    double time_limit = argc > 3 ? std::stod(argv[3]) : 60;
+
+    clique_solver::MaxCliqueSolver::Params pmc_params;
+    pmc_params.time_limit = time_limit;
+    clique_solver::MaxCliqueSolver::Params bitset_params = pmc_params;
+    bitset_params.solver_mode = clique_solver::MaxCliqueSolver::CLIQUE_SOLVER_MODE::BITSET;
+
+    int mismatches = 0;
+    std::vector<std::string> lines;
+    for (int num_vertices: {500, 1000, 2000}) {
+        for (double density: {0.02, 0.05, 0.1, 0.2, 0.3, 0.5}) {
+            clique_solver::Graph graph = CompatibilityGraph(num_vertices, density, num_inliers, num_vertices);
+            std::vector<int> pmc_clique, bitset_clique;
+            double pmc_ms = Best(pmc_params, graph, repeats, &pmc_clique);
+            double bitset_ms = Best(bitset_params, graph, repeats, &bitset_clique);
+            // PMC returns the best clique so far when it runs out of time, the bitset solver must not do worse
+            bool pmc_timeout = pmc_ms > time_limit * 1e3;
+            bool equal = (pmc_timeout ? pmc_clique.size() <= bitset_clique.size()
+                                      : pmc_clique.size() == bitset_clique.size()) && IsClique(graph, bitset_clique);
+            mismatches += !equal;
+
+            std::ostringstream line;
+            line << std::left << std::setw(7) << num_vertices << std::setw(9) << density << std::right
+                 << std::setw(10) << graph.numEdges() << std::setw(8) << bitset_clique.size() << std::fixed
+                 << std::setprecision(3) << std::setw(12) << pmc_ms << std::setw(12) << bitset_ms
+                 << std::setprecision(2) << std::setw(10) << pmc_ms / bitset_ms << std::setw(9)
+                 << (!equal ? "NO" : pmc_timeout ? "timeout" : "yes");
+            lines.push_back(line.str());
+        }
+    }
+    // PMC logs while it searches, so the table comes last
+    std::cout << std::left << std::setw(7) << "V" << std::setw(9) << "density" << std::right << std::setw(10)
+              << "edges" << std::setw(8) << "clique" << std::setw(12) << "pmc_ms" << std::setw(12) << "bitset_ms"
+              << std::setw(10) << "speedup" << std::setw(9) << "equal" << std::endl;
+    for (const auto &line: lines) {
+        std::cout << line << std::endl;
+    }
+    if (mismatches > 0) {
+        std::cout << mismatches << " graphs where the solvers disagree" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <set>
+#include "datasets/datasets_init.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+using namespace g3reg;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Usage: deskew_bm config_file test_file [max_scans]" << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    InitGLOG(config_path, argv);
+    config.load_config(config_path, argv);
+    int max_scans = argc > 3 ? std::stoi(argv[3]) : 200;
+
+    std::shared_ptr<KITTI360Loader> loader = std::dynamic_pointer_cast<KITTI360Loader>(CreateDataLoader());
+    if (loader == nullptr) {
+        LOG(ERROR) << "deskew_bm needs a kitti360 config";
+        return -1;
+    }
+    std::set<std::pair<int, int>> scans;
+    for (const auto &item: loader->items) {
+        scans.insert({item.seq, item.src_idx});
+        scans.insert({item.seq_db, item.tgt_idx});
+    }
+
+    int num = 0;
+    double exact_time = 0, fast_time = 0, max_error = 0, max_bound = 0;
+    for (const auto &scan: scans) {
+        if (num >= max_scans) {
+            break;
+        }
+        Eigen::Matrix4d ego_motion = loader->getEgoMotion(scan.first, scan.second);
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = ReadBinXYZ(
+                loader->GetScanPath(config.dataset_root, scan.first, scan.second));
+        if (cloud == nullptr || (ego_motion - Eigen::Matrix4d::Identity()).norm() <= 0.1) {
+            continue;
+        }
+        Eigen::Vector3d rho = robot_utils::R2so3(Eigen::Matrix3d(ego_motion.block<3, 3>(0, 0)));
+        Eigen::Vector3d t = ego_motion.block<3, 1>(0, 3);
+        pcl::PointCloud<pcl::PointXYZ>::Ptr exact(new pcl::PointCloud<pcl::PointXYZ>(*cloud));
+        pcl::PointCloud<pcl::PointXYZ>::Ptr fast(new pcl::PointCloud<pcl::PointXYZ>(*cloud));
+
+        robot_utils::TicToc timer;
+        loader->deskew(exact, rho, t);
+        exact_time += timer.toc();
+        double bound = loader->deskewFast(fast, rho, t, config.deskew_bins);
+        fast_time += timer.toc();
+
+        for (size_t i = 0; i < cloud->size(); i++) {
+            max_error = std::max(max_error, double((exact->points[i].getVector3fMap() -
+                                                    fast->points[i].getVector3fMap()).norm()));
+        }
+        max_bound = std::max(max_bound, bound);
+        num++;
+    }
+    if (num == 0) {
+        LOG(ERROR) << "No scan with ego motion to deskew";
+        return -1;
+    }
+    LOG(INFO) << std::fixed << std::setprecision(4) << "Deskewed " << num << " scans, exact " << exact_time / num
+              << " ms/scan, fast (" << config.deskew_bins << " bins) " << fast_time / num
+              << " ms/scan, max error " << max_error << " m, max bound " << max_bound << " m";
+    return 0;
+}
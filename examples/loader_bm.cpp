@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
+#include "dataset/kitti_utils.h"
+#include "datasets/bin_reader.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+
+// drop the scan from the page cache, so that the next read goes to the disk
+void evict(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+void run(const std::string &name, const std::vector<std::string> &scans, bool cold,
+         const std::function<size_t(const std::string &)> &read_scan) {
+    std::vector<double> latency;
+    double total_bytes = 0, total_ms = 0;
+    size_t total_points = 0;
+    for (const auto &scan: scans) {
+        if (cold) {
+            evict(scan);
+        }
+        robot_utils::TicToc timer;
+        total_points += read_scan(scan);
+        double ms = timer.toc();
+        latency.push_back(ms);
+        total_ms += ms;
+        total_bytes += std::filesystem::file_size(scan);
+    }
+    std::sort(latency.begin(), latency.end());
+    std::cout << std::fixed << std::setprecision(3) << name << ": " << total_bytes / 1e6 / (total_ms / 1e3)
+              << " MB/s, per scan mean " << total_ms / scans.size() << " ms, p50 " << latency[latency.size() / 2]
+              << " ms, max " << latency.back() << " ms, points " << total_points / scans.size() << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: loader_bm scan_dir [max_scans] [min_range] [max_range] [cold]" << std::endl;
+        return -1;
+    }
+    std::string scan_dir = argv[1];
+    int max_scans = argc > 2 ? std::stoi(argv[2]) : 500;
+    double min_range = argc > 3 ? std::stod(argv[3]) : 2.0;
+    double max_range = argc > 4 ? std::stod(argv[4]) : 80.0;
+    bool cold = argc > 5 && std::string(argv[5]) == "cold";
+
+    std::vector<std::string> scans;
+    for (const auto &entry: std::filesystem::directory_iterator(scan_dir)) {
+        if (entry.path().extension() == ".bin") {
+            scans.push_back(entry.path().string());
+        }
+    }
+    std::sort(scans.begin(), scans.end());
+    if (scans.size() > max_scans) {
+        scans.resize(max_scans);
+    }
+    if (scans.empty()) {
+        std::cout << "No .bin scans in " << scan_dir << std::endl;
+        return -1;
+    }
+    std::cout << "Scans: " << scans.size() << (cold ? ", cold page cache" : ", warm page cache") << std::endl;
+
+    // warm up once so that the warm runs do not pay for the first read
+    if (!cold) {
+        for (const auto &scan: scans) {
+            g3reg::ReadBinXYZ(scan);
+        }
+    }
+    run("ifstream ReadCloudXYZ", scans, cold, [](const std::string &scan) {
+        return kitti_utils::ReadCloudXYZ(scan)->size();
+    });
+    run("mmap ReadBinXYZ", scans, cold, [](const std::string &scan) {
+        return g3reg::ReadBinXYZ(scan)->size();
+    });
+    run("mmap ReadBinXYZ + range crop", scans, cold, [min_range, max_range](const std::string &scan) {
+        return g3reg::ReadBinXYZ(scan, min_range, max_range)->size();
+    });
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <pcl/io/pcd_io.h>
+#include "datasets/datasets_init.h"
+#include "datasets/pcd_reader.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+using namespace g3reg;
+
+// pcd path of a scan for the loaders that read pcd files
+std::string scan_path(const DataLoader::Ptr &dataloader_ptr, int seq, int i) {
+    if (auto apollo = std::dynamic_pointer_cast<ApolloLoader>(dataloader_ptr)) {
+        return apollo->GetScanPath(config.dataset_root, seq, i);
+    }
+    if (auto hit = std::dynamic_pointer_cast<HITLoader>(dataloader_ptr)) {
+        return hit->GetScanPath(config.dataset_root, seq, i);
+    }
+    return "";
+}
+
+void run(const std::string &name, const std::vector<std::string> &scans, std::vector<size_t> &num_points,
+         const std::function<size_t(const std::string &)> &read_scan) {
+    std::vector<double> latency;
+    double total_bytes = 0, total_ms = 0;
+    num_points.clear();
+    for (const auto &scan: scans) {
+        robot_utils::TicToc timer;
+        num_points.push_back(read_scan(scan));
+        double ms = timer.toc();
+        latency.push_back(ms);
+        total_ms += ms;
+        total_bytes += std::filesystem::file_size(scan);
+    }
+    std::sort(latency.begin(), latency.end());
+    LOG(INFO) << std::fixed << std::setprecision(3) << name << ": " << total_bytes / 1e6 / (total_ms / 1e3)
+              << " MB/s, per scan mean " << total_ms / scans.size() << " ms, p50 " << latency[latency.size() / 2]
+              << " ms, max " << latency.back() << " ms";
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Usage: pcd_bm config_file test_file" << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    InitGLOG(config_path, argv);
+    config.load_config(config_path, argv);
+
+    DataLoader::Ptr dataloader_ptr = CreateDataLoader();
+    std::set<std::string> unique_scans;
+    for (const auto &item: dataloader_ptr->items) {
+        unique_scans.insert(scan_path(dataloader_ptr, item.seq, item.src_idx));
+        unique_scans.insert(scan_path(dataloader_ptr, item.seq_db, item.tgt_idx));
+    }
+    unique_scans.erase("");
+    std::vector<std::string> scans;
+    for (const auto &scan: unique_scans) {
+        if (std::filesystem::exists(scan)) {
+            scans.push_back(scan);
+        }
+    }
+    if (scans.empty()) {
+        LOG(ERROR) << "No pcd scans found, pcd_bm supports the apollo and hit_ms datasets";
+        return -1;
+    }
+    LOG(INFO) << "Scans: " << scans.size();
+
+    // warm up the page cache so that both readers parse from memory
+    for (const auto &scan: scans) {
+        ReadPCDXYZ(scan);
+    }
+    std::vector<size_t> pcl_points, fast_points;
+    run("pcl::io::loadPCDFile", scans, pcl_points, [](const std::string &scan) {
+        pcl::PointCloud<pcl::PointXYZ> cloud;
+        pcl::io::loadPCDFile<pcl::PointXYZ>(scan, cloud);
+        return cloud.size();
+    });
+    run("ReadPCDXYZ", scans, fast_points, [](const std::string &scan) {
+        auto cloud = ReadPCDXYZ(scan);
+        return cloud == nullptr ? size_t(0) : cloud->size();
+    });
+    size_t mismatch = 0;
+    for (size_t i = 0; i < scans.size(); i++) {
+        mismatch += pcl_points[i] != fast_points[i];
+    }
+    LOG(INFO) << "Scans with a different number of points: " << mismatch;
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <yaml-cpp/yaml.h>
+#include "utils/config.h"
+#include "utils/trace.h"
+#include "utils/memory.h"
+#include "utils/synthetic.h"
+#include "back_end/reglib.h"
+
+using namespace std;
+using namespace g3reg;
+
+// the numbers compared between runs
+struct PerfSummary {
+    int num_pairs = 0, repeats = 0;
+    double success_rate = 0, peak_rss_mb = 0;
+    std::map<std::string, TraceStats> stages;
+};
+
+bool SaveBaseline(const std::string &path, const PerfSummary &summary) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << std::fixed << std::setprecision(4) << "{\n  \"num_pairs\": " << summary.num_pairs << ",\n  \"repeats\": "
+         << summary.repeats << ",\n  \"success_rate\": " << summary.success_rate << ",\n  \"peak_rss_mb\": "
+         << summary.peak_rss_mb << ",\n  \"stages\": {";
+    bool first = true;
+    for (const auto &entry: summary.stages) {
+        const TraceStats &s = entry.second;
+        file << (first ? "\n" : ",\n") << "    \"" << s.stage << "\": {\"count\": " << s.count << ", \"p50_ms\": "
+             << s.p50_ms << ", \"p99_ms\": " << s.p99_ms << "}";
+        first = false;
+    }
+    file << "\n  }\n}\n";
+    return file.good();
+}
+
+// JSON is a subset of YAML, so the baseline is read back with yaml-cpp
+bool LoadBaseline(const std::string &path, PerfSummary &summary) {
+    YAML::Node node;
+    try {
+        node = YAML::LoadFile(path);
+    } catch (const YAML::Exception &e) {
+        LOG(ERROR) << "Cannot read baseline " << path << ": " << e.what();
+        return false;
+    }
+    summary.num_pairs = node["num_pairs"].as<int>();
+    summary.repeats = node["repeats"].as<int>();
+    summary.success_rate = node["success_rate"].as<double>();
+    summary.peak_rss_mb = node["peak_rss_mb"].as<double>();
+    for (const auto &stage: node["stages"]) {
+        TraceStats s;
+        s.stage = stage.first.as<std::string>();
+        s.count = stage.second["count"].as<size_t>();
+        s.p50_ms = stage.second["p50_ms"].as<double>();
+        s.p99_ms = stage.second["p99_ms"].as<double>();
+        summary.stages[s.stage] = s;
+    }
+    return true;
+}
+
+/**
+ * Register fixed synthetic pairs repeats times with stage tracing enabled.
+ * The pairs are scans of the same street taken 2 to 12 m and up to 25 deg apart.
+ */
+PerfSummary RunPairs(int repeats) {
+    SyntheticScene scene;
+    std::vector<std::pair<pcl::PointCloud<pcl::PointXYZ>::Ptr, pcl::PointCloud<pcl::PointXYZ>::Ptr>> pairs;
+    std::vector<Eigen::Matrix4d> gt_tfs;
+    const double offsets[][3] = {{2, 0, 0}, {4, 0.5, 5}, {6, -0.5, 10}, {8, 1, 15}, {10, -1, 20}, {12, 0, 25}};
+    for (int i = 0; i < 6; i++) {
+        Eigen::Matrix4d src_pose = StreetPose(0, 0, 0);
+        Eigen::Matrix4d tgt_pose = StreetPose(offsets[i][0], offsets[i][1], offsets[i][2]);
+        pairs.emplace_back(scene.scan(src_pose, LidarParams(), 2 * i),
+                           scene.scan(tgt_pose, LidarParams(), 2 * i + 1));
+        gt_tfs.push_back(tgt_pose.inverse() * src_pose);
+    }
+
+    PerfSummary summary;
+    summary.num_pairs = pairs.size();
+    summary.repeats = repeats;
+    int success = 0;
+    ResetPeakRss();
+    Tracer::instance().clear();
+    Tracer::instance().setEnabled(true);
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < pairs.size(); i++) {
+            FRGresult result = GlobalRegistration(pairs[i].first, pairs[i].second,
+                                                  std::make_tuple(0, 2 * i, 2 * i + 1));
+            Eigen::Matrix4d err = gt_tfs[i].inverse() * result.tf;
+            double rot_err = std::acos(std::min(1.0, std::max(-1.0, (err.block<3, 3>(0, 0).trace() - 1) / 2))) *
+                             180.0 / M_PI;
+            if (rot_err < config.rot_thresh && err.block<3, 1>(0, 3).norm() < config.trans_thresh) {
+                success++;
+            }
+        }
+    }
+    Tracer::instance().setEnabled(false);
+    summary.success_rate = 100.0 * success / (repeats * pairs.size());
+    summary.peak_rss_mb = PeakRssMb();
+    for (const auto &s: Tracer::instance().statistics()) {
+        summary.stages[s.stage] = s;
+    }
+    return summary;
+}
+
+/**
+ * Print the baseline against the current run and count the regressions.
+ * A stage regresses when its p50 or p99 grows by more than tolerance and by more than min_ms, so that sub-
+ * millisecond stages do not flag scheduler noise.
+ */
+int Compare(const PerfSummary &baseline, const PerfSummary &current, double tolerance, double min_ms) {
+    int regressions = 0;
+    auto check = [&](const std::string &name, double base, double now, double slack) {
+        bool regressed = now > base * (1 + tolerance) && now - base > slack;
+        regressions += regressed;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3) << std::left << std::setw(36) << name << std::right
+             << std::setw(12) << base << std::setw(12) << now << std::setw(9) << std::setprecision(1)
+             << (base > 0 ? 100.0 * (now - base) / base : 0.0) << "%" << (regressed ? "  REGRESSION" : "");
+        if (regressed) {
+            LOG(ERROR) << line.str();
+        } else {
+            LOG(INFO) << line.str();
+        }
+    };
+    LOG(INFO) << std::left << std::setw(36) << "metric" << std::right << std::setw(12) << "baseline" << std::setw(12)
+              << "current" << std::setw(10) << "change";
+    for (const auto &entry: baseline.stages) {
+        auto it = current.stages.find(entry.first);
+        if (it == current.stages.end()) {
+            LOG(WARNING) << entry.first << " is missing in the current run";
+            continue;
+        }
+        check(entry.first + " p50_ms", entry.second.p50_ms, it->second.p50_ms, min_ms);
+        check(entry.first + " p99_ms", entry.second.p99_ms, it->second.p99_ms, min_ms);
+    }
+    // a few MB of allocator noise is not a regression either
+    check("peak_rss_mb", baseline.peak_rss_mb, current.peak_rss_mb, 8);
+    if (current.success_rate < baseline.success_rate) {
+        LOG(ERROR) << "success rate dropped from " << baseline.success_rate << "% to " << current.success_rate
+                   << "%  REGRESSION";
+        regressions++;
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Usage: perf_regression config_file baseline.json [record|check] [tolerance] [repeats] [min_ms]"
+                  << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    std::string baseline_path = argv[2];
+    std::string mode = argc > 3 ? argv[3] : "check";
+    double tolerance = argc > 4 ? std::stod(argv[4]) : 0.1;
+    int repeats = argc > 5 ? std::stoi(argv[5]) : 5;
+    double min_ms = argc > 6 ? std::stod(argv[6]) : 0.5;
+    InitGLOG(config_path, nullptr);
+    config.load_config(config_path);
+
+    PerfSummary current = RunPairs(repeats);
+    if (mode == "record") {
+        if (!SaveBaseline(baseline_path, current)) {
+            LOG(ERROR) << "Cannot write baseline " << baseline_path;
+            return -1;
+        }
+        LOG(INFO) << "Baseline saved to " << baseline_path << ", success rate " << current.success_rate
+                  << "%, peak rss " << current.peak_rss_mb << " MB";
+        return 0;
+    }
+
+    PerfSummary baseline;
+    if (!LoadBaseline(baseline_path, baseline)) {
+        return -1;
+    }
+    SaveBaseline(config.log_dir + "/perf_current.json", current);
+    int regressions = Compare(baseline, current, tolerance, min_ms);
+    if (regressions > 0) {
+        LOG(ERROR) << regressions << " regressions beyond " << tolerance * 100 << "% against " << baseline_path;
+        return 1;
+    }
+    LOG(INFO) << "No regressions beyond " << tolerance * 100 << "% against " << baseline_path;
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "datasets/datasets_init.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+using namespace g3reg;
+
+// time to load the poses of every sequence in the test file and look up all pair poses
+double load_poses(DataLoader::Ptr &dataloader_ptr, bool pose_cache, Eigen::Matrix4d &checksum) {
+    config.pose_cache = pose_cache;
+    dataloader_ptr->lidar_poses.clear();
+    robot_utils::TicToc timer;
+    checksum.setZero();
+    for (const auto &item: dataloader_ptr->items) {
+        checksum += dataloader_ptr->getLidarPose(config.dataset_root, item.seq, item.src_idx);
+        checksum += dataloader_ptr->getLidarPose(config.dataset_root, item.seq_db, item.tgt_idx);
+    }
+    return timer.toc();
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Usage: pose_bm config_file test_file" << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    InitGLOG(config_path, argv);
+    config.load_config(config_path, argv);
+
+    DataLoader::Ptr dataloader_ptr = CreateDataLoader();
+    Eigen::Matrix4d text_sum, first_sum, cached_sum;
+    double text_time = load_poses(dataloader_ptr, false, text_sum);
+    // caches left by earlier runs would turn the next pass into a cache read
+    for (const auto &poses: dataloader_ptr->lidar_poses) {
+        if (!poses.second.removeCache()) {
+            LOG(WARNING) << "Cannot remove the pose cache of sequence " << poses.first;
+        }
+    }
+    double first_time = load_poses(dataloader_ptr, true, first_sum);
+    double cached_time = load_poses(dataloader_ptr, true, cached_sum);
+
+    LOG(INFO) << std::fixed << std::setprecision(3) << "Pose startup for " << dataloader_ptr->items.size()
+              << " pairs, " << dataloader_ptr->lidar_poses.size() << " sequences: text " << text_time
+              << " ms, text + cache write " << first_time << " ms, binary cache " << cached_time << " ms"
+              << ", max diff " << (text_sum - cached_sum).cwiseAbs().maxCoeff();
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+#include "clique_solver/graph.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+
+// the previous Graph::pruneGraph, one erase and renumbering of every adjacency list per removed vertex
+void LegacyPrune(std::vector<std::vector<int>> &adj_list, int degree) {
+    std::vector<int> vertices_to_remove;
+    for (size_t i = 0; i < adj_list.size(); ++i) {
+        if (adj_list[i].size() < static_cast<size_t>(degree)) {
+            vertices_to_remove.push_back(i);
+        }
+    }
+    for (auto it = vertices_to_remove.rbegin(); it != vertices_to_remove.rend(); ++it) {
+        const int vertex = *it;
+        for (auto &edges: adj_list) {
+            edges.erase(std::remove(edges.begin(), edges.end(), vertex), edges.end());
+        }
+        adj_list.erase(adj_list.begin() + vertex);
+        for (auto &edges: adj_list) {
+            for (auto &e: edges) {
+                if (e > vertex) {
+                    --e;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Compatibility graph of a registration problem: a clique of inliers planted among vertices connected with
+ * probability density, in random order.
+ */
+std::map<int, std::vector<int>> CompatibilityGraph(int num_vertices, double density, int num_inliers, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::vector<int> order(num_vertices);
+    for (int i = 0; i < num_vertices; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<char> inlier(num_vertices, 0);
+    for (int i = 0; i < num_inliers; i++) {
+        inlier[order[i]] = 1;
+    }
+    std::map<int, std::vector<int>> adj_list;
+    for (int i = 0; i < num_vertices; i++) {
+        adj_list[i];
+        for (int j = i + 1; j < num_vertices; j++) {
+            if ((inlier[i] && inlier[j]) || unit(rng) < density) {
+                adj_list[i].push_back(j);
+                adj_list[j].push_back(i);
+            }
+        }
+    }
+    return adj_list;
+}
+
+/**
+ * Prune compatibility graphs to the core of the planted clique (degree num_inliers - 1) with Graph::pruneGraph,
+ * and up to legacy_max_vertices vertices also with the previous vertex by vertex removal repeated until nothing
+ * changes. Both must leave the same graph, which keeps the planted clique.
+ */
+int main(int argc, char **argv) {
+    int legacy_max_vertices = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int max_vertices = argc > 2 ? std::stoi(argv[2]) : 10000;
+
+    int mismatches = 0;
+    std::cout << std::left << std::setw(9) << "V" << std::setw(9) << "density" << std::right << std::setw(11)
+              << "edges" << std::setw(8) << "kept" << std::setw(13) << "legacy_ms" << std::setw(11) << "bulk_ms"
+              << std::setw(10) << "speedup" << std::setw(8) << "equal" << std::endl;
+    for (int num_vertices: {1000, 2000, 5000, 10000}) {
+        if (num_vertices > max_vertices) {
+            continue;
+        }
+        for (double density: {0.05, 0.2}) {
+            const int num_inliers = 1.5 * density * num_vertices;
+            std::map<int, std::vector<int>> adj_list = CompatibilityGraph(num_vertices, density, num_inliers,
+                                                                          num_vertices);
+            clique_solver::Graph graph(adj_list);
+            const int num_edges = graph.numEdges();
+
+            robot_utils::TicToc bulk_timer;
+            std::vector<int> old_to_new = graph.pruneGraph(num_inliers - 1);
+            double bulk_ms = bulk_timer.toc();
+            // the planted clique survives and the kept lists are the old ones through the index map
+            bool equal = graph.numVertices() >= num_inliers;
+            for (int i = 0; i < num_vertices && equal; i++) {
+                if (old_to_new[i] < 0) {
+                    continue;
+                }
+                std::vector<int> edges;
+                for (int e: adj_list[i]) {
+                    if (old_to_new[e] >= 0) {
+                        edges.push_back(old_to_new[e]);
+                    }
+                }
+                equal = edges == graph.getEdges(old_to_new[i]);
+            }
+
+            double legacy_ms = -1;
+            if (num_vertices <= legacy_max_vertices) {
+                std::vector<std::vector<int>> legacy(num_vertices);
+                for (int i = 0; i < num_vertices; i++) {
+                    legacy[i] = adj_list[i];
+                }
+                robot_utils::TicToc legacy_timer;
+                size_t last_size;
+                do {
+                    last_size = legacy.size();
+                    LegacyPrune(legacy, num_inliers - 1);
+                } while (legacy.size() != last_size);
+                legacy_ms = legacy_timer.toc();
+                equal = equal && legacy == graph.getAdjList();
+            }
+            mismatches += !equal;
+
+            std::cout << std::left << std::setw(9) << num_vertices << std::setw(9) << density << std::right
+                      << std::setw(11) << num_edges << std::setw(8) << graph.numVertices() << std::fixed
+                      << std::setprecision(2) << std::setw(13) << legacy_ms << std::setw(11) << bulk_ms
+                      << std::setw(10) << (legacy_ms > 0 ? legacy_ms / bulk_ms : 0) << std::setw(8)
+                      << (equal ? "yes" : "NO") << std::endl;
+        }
+    }
+    if (mismatches > 0) {
+        std::cout << mismatches << " graphs where the bulk pruning differs" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -3,7 +3,9 @@
 #include <string>
 #include <Eigen/Core>
 #include "datasets/datasets_init.h"
+#include "datasets/prefetcher.h"
 #include "back_end/reglib.h"
+#include "utils/trace.h"
 #include <iomanip>
 
 using namespace std;
@@ -23,17 +25,25 @@ int main(int argc, char **argv) {
     DataLoader::Ptr dataloader_ptr = CreateDataLoader();
     auto &items = dataloader_ptr->items;
 
+    // the clouds of the next pairs are loaded while the current pair is registered
+    PairPrefetcher::Params prefetch_params;
+    prefetch_params.queue_depth = config.prefetch_pairs;
+    prefetch_params.num_threads = config.prefetch_threads;
+    prefetch_params.memory_mb = config.prefetch_memory_mb;
+    prefetch_params.voxel_size = config.prefetch_voxel_size;
+    PairPrefetcher prefetcher(dataloader_ptr, prefetch_params);
+    Tracer::instance().setEnabled(config.trace_stages);
+
     int pair_idx = 0;
     Evaluation eval;
     std::map<int, Evaluation> eval_seq_map;
-    for (auto &item: items) {
-
-        pcl::PointCloud<pcl::PointXYZ>::Ptr src_cloud = dataloader_ptr->GetCloud(config.dataset_root, item.seq,
-                                                                                 item.src_idx);
-        pcl::PointCloud<pcl::PointXYZ>::Ptr tgt_cloud = dataloader_ptr->GetCloud(config.dataset_root, item.seq_db,
-                                                                                 item.tgt_idx);
-        FRGresult solution = g3reg::GlobalRegistration(src_cloud, tgt_cloud,
+    PairPrefetcher::Pair pair;
+    double io_stall_time = 0;
+    while (prefetcher.next(pair, io_stall_time)) {
+        const DataLoader::Item &item = pair.item;
+        FRGresult solution = g3reg::GlobalRegistration(pair.src_cloud, pair.tgt_cloud,
                                                        std::make_tuple(item.seq, item.src_idx, item.tgt_idx));
+        solution.io_stall_time = io_stall_time;
 
         bool success_flag_upper = false, success_flag = false;
         std::tie(success_flag, success_flag_upper) = eval.update(solution, item.pose);
@@ -50,6 +60,7 @@ int main(int argc, char **argv) {
                   << ", time front/graph/clique/solve_tf/verify/total: " << eval.feature_time << "/" << eval.graph_time
                   << "/" << eval.clique_time
                   << "/" << eval.tf_solver_time << "/" << eval.verify_time << "/" << eval.total_time << " ms"
+                  << ", io stall: " << eval.io_stall_time << " ms"
                   << ", inliers: " << eval.plane_inliers << "/" << eval.line_inliers << "/" << eval.cluster_inliers
                   << ", ol: " << item.overlap << ", trans:" << item.pose.block<3, 1>(0, 3).norm();
     }
@@ -58,10 +69,47 @@ int main(int argc, char **argv) {
     LOG(INFO) << "Evaluation for all sequences: ";
     eval.computePoseErr();
     eval.saveStatistics(config.log_dir);
+    if (config.trace_stages) {
+        Tracer::instance().setEnabled(false);
+        Tracer::instance().saveChromeTrace(config.log_dir + "/runtimes/trace.json");
+        Tracer::instance().saveStatistics(config.log_dir + "/runtimes/stage_times.txt");
+        LOG(INFO) << "Stage times (ms) count/mean/p50/p90/p99/max, trace saved to " << config.log_dir
+                  << "/runtimes/trace.json";
+        for (const auto &s: Tracer::instance().statistics()) {
+            LOG(INFO) << std::fixed << std::setprecision(3) << s.stage << ": " << s.count << "/" << s.mean_ms << "/"
+                      << s.p50_ms << "/" << s.p90_ms << "/" << s.p99_ms << "/" << s.max_ms;
+        }
+    }
+    if (config.memory_stages && !eval.memories.empty()) {
+        // mean over pairs, the peak is the worst pair
+        std::map<std::string, StageMemory> stage_memory;
+        std::vector<std::string> stage_order;
+        for (const auto &memory: eval.memories) {
+            for (const auto &m: memory) {
+                if (stage_memory.find(m.stage) == stage_memory.end()) {
+                    stage_order.push_back(m.stage);
+                }
+                StageMemory &s = stage_memory[m.stage];
+                s.allocs += m.allocs;
+                s.alloc_mb += m.alloc_mb;
+                s.peak_heap_mb = std::max(s.peak_heap_mb, m.peak_heap_mb);
+                s.peak_rss_mb = std::max(s.peak_rss_mb, m.peak_rss_mb);
+            }
+        }
+        LOG(INFO) << "Stage memory allocs/alloc_mb per pair, max peak_heap_mb/peak_rss_mb"
+                  << (HeapCounters::enabled() ? "" : " (allocations need -DG3REG_COUNT_ALLOCS=ON)") << ", saved to "
+                  << config.log_dir << "/runtimes/memory.txt";
+        for (const auto &stage: stage_order) {
+            const StageMemory &s = stage_memory[stage];
+            LOG(INFO) << std::fixed << std::setprecision(1) << stage << ": " << double(s.allocs) / eval.memories.size()
+                      << "/" << s.alloc_mb / eval.memories.size() << "/" << s.peak_heap_mb << "/" << s.peak_rss_mb;
+        }
+    }
     LOG(INFO) << "Succ ratio: " << eval.success_rate << "/" << eval.success_rate_upper
               << " Time front/graph/clique/solve_tf/verify/total: " << eval.feature_time_avg << "/"
               << eval.graph_time_avg << "/" << eval.clique_time_avg
               << "/" << eval.solver_time_avg << "/" << eval.verify_time_avg << "/" << eval.total_time_avg << " ms"
+              << ", io stall: " << eval.io_stall_time_avg << " ms"
               << ", inliers: " << eval.plane_inliers_avg << "/" << eval.line_inliers_avg << "/"
               << eval.cluster_inliers_avg
               << "Rot MAE: " << eval.rot_err_mae << ", RMSE: " << eval.rot_err_rmse << ", translation MAE: "
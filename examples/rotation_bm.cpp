@@ -0,0 +1,236 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <Eigen/Geometry>
+#include "back_end/teaser/registration.h"
+#include "utils/opt_utils.h"
+#include "utils/memory.h"
+#include "robot_utils/tic_toc.h"
+#include "robot_utils/eigen_types.h"
+
+using namespace std;
+using namespace g3reg;
+
+typedef Eigen::Matrix<bool, 1, Eigen::Dynamic> Inliers;
+
+// GNCTLSRotationSolver::solveForRotation before the workspace, with per-iteration dynamic temporaries
+void ReferenceGncTls(const Eigen::Matrix3Xd &src, const Eigen::Matrix3Xd &dst,
+                     const teaser::GNCRotationSolver::Params &params, Eigen::Matrix3d *rotation, Inliers *inliers) {
+    size_t match_size = src.cols();
+    double mu = 1;
+    double prev_cost = std::numeric_limits<double>::infinity();
+    double noise_bound_sq = std::pow(params.noise_bound, 2);
+    if (noise_bound_sq < 1e-16) {
+        noise_bound_sq = 1e-2;
+    }
+    Eigen::Matrix<double, 3, Eigen::Dynamic> diffs(3, match_size);
+    Eigen::Matrix<double, 1, Eigen::Dynamic> weights = Eigen::RowVectorXd::Ones(match_size);
+    Eigen::Matrix<double, 1, Eigen::Dynamic> residuals_sq(1, match_size);
+    for (size_t i = 0; i < params.max_iterations; ++i) {
+        *rotation = gtsam::svdRot(src, dst, weights);
+        diffs = (dst - (*rotation) * src).array().square();
+        residuals_sq = diffs.colwise().sum();
+        if (i == 0) {
+            mu = 1 / (2 * residuals_sq.maxCoeff() / noise_bound_sq - 1);
+            if (mu <= 0) {
+                break;
+            }
+        }
+        double th1 = (mu + 1) / mu * noise_bound_sq;
+        double th2 = mu / (mu + 1) * noise_bound_sq;
+        double cost = 0;
+        for (size_t j = 0; j < match_size; ++j) {
+            cost += weights(j) * residuals_sq(j);
+            if (residuals_sq(j) >= th1) {
+                weights(j) = 0;
+            } else if (residuals_sq(j) <= th2) {
+                weights(j) = 1;
+            } else {
+                weights(j) = sqrt(noise_bound_sq * mu * (mu + 1) / residuals_sq(j)) - mu;
+            }
+        }
+        double cost_diff = std::abs(cost - prev_cost);
+        mu = mu * params.gnc_factor;
+        prev_cost = cost;
+        if (cost_diff < params.cost_threshold) {
+            break;
+        }
+    }
+    *inliers = weights.array() >= 0.5;
+}
+
+// FastGlobalRegistrationSolver::solveForRotation before the workspace
+void ReferenceFgr(const Eigen::Matrix3Xd &src, const Eigen::Matrix3Xd &dst,
+                  const teaser::GNCRotationSolver::Params &params, Eigen::Matrix3d *rotation, Inliers *inliers) {
+    double noise_bound_sq = std::pow(params.noise_bound, 2);
+    size_t match_size = src.cols();
+    double src_diameter = robot_utils::calculateDiameter<double, 3>(src);
+    double dest_diameter = robot_utils::calculateDiameter<double, 3>(dst);
+    double global_scale = std::max(src_diameter, dest_diameter) / noise_bound_sq;
+    double mu = std::pow(global_scale, 2) / noise_bound_sq;
+    *rotation = Eigen::Matrix3d::Identity();
+    Eigen::Matrix<double, 1, Eigen::Dynamic> l_pq = Eigen::RowVectorXd::Ones(match_size);
+    for (size_t i = 0; i < params.max_iterations; ++i) {
+        double scaled_mu = mu * noise_bound_sq;
+        for (size_t j = 0; j < match_size; ++j) {
+            Eigen::Vector3d rpq = dst.col(j) - (*rotation) * src.col(j);
+            l_pq(j) = std::pow(scaled_mu / (scaled_mu + rpq.squaredNorm()), 2);
+        }
+        *rotation = gtsam::svdRot(src, dst, l_pq);
+        Eigen::Matrix<double, 3, Eigen::Dynamic> diff = (dst - (*rotation) * src).array().square();
+        double cost = ((scaled_mu * diff.colwise().sum()).array() /
+                       (scaled_mu + diff.colwise().sum().array()).array()).sum();
+        if (cost < params.cost_threshold || mu < 1.0) {
+            break;
+        }
+        mu /= params.gnc_factor;
+    }
+    *inliers = l_pq.cast<bool>();
+}
+
+// RobustRegistrationSolver::computeTIMs before the blocked builder, one temporary per row of the triangle
+Eigen::Matrix3Xd ReferenceTims(const Eigen::Matrix3Xd &v, Eigen::Matrix<int, 2, Eigen::Dynamic> *map) {
+    auto N = v.cols();
+    Eigen::Matrix<double, 3, Eigen::Dynamic> vtilde(3, N * (N - 1) / 2);
+    map->resize(2, N * (N - 1) / 2);
+#pragma omp parallel for default(none) shared(N, v, vtilde, map)
+    for (size_t i = 0; i < N - 1; i++) {
+        size_t segment_start_idx = i * N - i * (i + 1) / 2;
+        size_t segment_cols = N - 1 - i;
+        Eigen::Matrix<double, 3, 1> m = v.col(i);
+        Eigen::Matrix<double, 3, Eigen::Dynamic> temp = v - m * Eigen::MatrixXd::Ones(1, N);
+        vtilde.middleCols(segment_start_idx, segment_cols) = temp.rightCols(segment_cols);
+        Eigen::Matrix<int, 2, Eigen::Dynamic> map_addition(2, N);
+        for (size_t j = 0; j < N; ++j) {
+            map_addition(0, j) = i;
+            map_addition(1, j) = j;
+        }
+        map->middleCols(segment_start_idx, segment_cols) = map_addition.rightCols(segment_cols);
+    }
+    return vtilde;
+}
+
+double AngleDeg(const Eigen::Matrix3d &R1, const Eigen::Matrix3d &R2) {
+    double c = ((R1.transpose() * R2).trace() - 1) / 2;
+    return std::acos(std::min(1.0, std::max(-1.0, c))) * 180.0 / M_PI;
+}
+
+/**
+ * Median time and heap allocations per call of op, the latter only when built with G3REG_COUNT_ALLOCS.
+ */
+void Bench(const std::string &name, int clique_size, size_t num_tims, int iterations,
+           const std::function<void()> &op) {
+    std::vector<double> ms;
+    size_t allocs = 0;
+    for (int i = 0; i <= iterations; i++) {
+        HeapCounters before = HeapCounters::read();
+        robot_utils::TicToc timer;
+        op();
+        double t = timer.toc();
+        if (i == 0) {
+            continue; // warmup
+        }
+        ms.push_back(t);
+        allocs += HeapCounters::read().allocs - before.allocs;
+    }
+    std::sort(ms.begin(), ms.end());
+    std::cout << std::left << std::setw(14) << name << std::right << std::setw(8) << clique_size << std::setw(10)
+              << num_tims << std::fixed << std::setprecision(4) << std::setw(12) << ms[ms.size() / 2]
+              << std::setprecision(1) << std::setw(12) << double(allocs) / iterations << std::endl;
+}
+
+/**
+ * Rotation solvers on the TIMs of max cliques, as PyramidRegistrationSolver hands them over for tf_solver
+ * teaser: the clique points are inliers up to noise plus a few outliers that slipped into the clique.
+ * The blocked TIMs, the workspace GNC-TLS and FGR must match the reference loops.
+ */
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+    double outlier_ratio = argc > 2 ? std::stod(argv[2]) : 0.1;
+    const double noise_bound = 0.2;
+
+    teaser::GNCRotationSolver::Params params{100, 1e-6, 1.4, 2 * noise_bound};
+    teaser::GNCTLSRotationSolver gnc_solver(params);
+    teaser::FastGlobalRegistrationSolver fgr_solver(params);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> box(-20, 20), unit(0, 1), angle(-M_PI, M_PI);
+    std::normal_distribution<double> noise(0, noise_bound / 3);
+    int mismatches = 0;
+
+    std::cout << std::left << std::setw(14) << "stage" << std::right << std::setw(8) << "clique" << std::setw(10)
+              << "tims" << std::setw(12) << "median_ms" << std::setw(12) << "allocs" << std::endl;
+    for (int clique_size: {10, 20, 50, 100, 200}) {
+        Eigen::Matrix3d R_gt = Eigen::AngleAxisd(angle(rng), Eigen::Vector3d(unit(rng), unit(rng), unit(rng))
+                .normalized()).toRotationMatrix();
+        Eigen::Matrix3Xd src(3, clique_size), dst(3, clique_size);
+        for (int i = 0; i < clique_size; i++) {
+            src.col(i) = Eigen::Vector3d(box(rng), box(rng), box(rng) / 4);
+            dst.col(i) = R_gt * src.col(i) + Eigen::Vector3d(3, -1, 0.5) +
+                         Eigen::Vector3d(noise(rng), noise(rng), noise(rng));
+            if (unit(rng) < outlier_ratio) {
+                dst.col(i) = Eigen::Vector3d(box(rng), box(rng), box(rng) / 4);
+            }
+        }
+        typedef teaser::RobustRegistrationSolver::INLIER_GRAPH_FORMULATION Formulation;
+        Eigen::Matrix3Xd src_tims, dst_tims;
+        teaser::RobustRegistrationSolver::computeTIMs(src, nullptr, Formulation::COMPLETE, &src_tims, nullptr);
+        teaser::RobustRegistrationSolver::computeTIMs(dst, nullptr, Formulation::COMPLETE, &dst_tims, nullptr);
+        const size_t num_tims = src_tims.cols();
+        // the TIMs of every other point, taken from the clique list against the gathered points
+        std::vector<int> clique;
+        Eigen::Matrix3Xd gathered(3, (clique_size + 1) / 2);
+        for (int i = 0; i < clique_size; i += 2) {
+            gathered.col(clique.size()) = src.col(i);
+            clique.push_back(i);
+        }
+        Eigen::Matrix<int, 2, Eigen::Dynamic> map, ref_map;
+        Eigen::Matrix3Xd clique_tims, ref_tims = ReferenceTims(gathered, &ref_map);
+        teaser::RobustRegistrationSolver::computeTIMs(src, &clique, Formulation::COMPLETE, &clique_tims, &map);
+        mismatches += clique_tims != ref_tims || map != ref_map || src_tims != ReferenceTims(src, &ref_map);
+
+        Eigen::Matrix3d R_ref, R_gnc, R_fgr_ref, R_fgr;
+        Inliers inliers_ref(1, num_tims), inliers_gnc(1, num_tims), inliers_fgr_ref(1, num_tims),
+                inliers_fgr(1, num_tims);
+        ReferenceGncTls(src_tims, dst_tims, params, &R_ref, &inliers_ref);
+        gnc_solver.solveForRotation(src_tims, dst_tims, &R_gnc, &inliers_gnc);
+        ReferenceFgr(src_tims, dst_tims, params, &R_fgr_ref, &inliers_fgr_ref);
+        fgr_solver.solveForRotation(src_tims, dst_tims, &R_fgr, &inliers_fgr);
+        // the accumulation order differs, so compare up to rounding, acos cannot resolve that near 1
+        double gnc_diff = (R_ref - R_gnc).norm(), fgr_diff = (R_fgr_ref - R_fgr).norm();
+        bool equal = gnc_diff < 1e-9 && inliers_ref == inliers_gnc && fgr_diff < 1e-9 &&
+                     inliers_fgr_ref == inliers_fgr;
+        mismatches += !equal;
+        std::cout << std::scientific << std::setprecision(3) << "clique " << clique_size << ": |R - R_ref| gnc " << gnc_diff << ", fgr "
+                  << fgr_diff << ", gnc inliers " << inliers_gnc.count() << "/" << inliers_ref.count()
+                  << ", error to gt gnc " << AngleDeg(R_gt, R_gnc) << " deg, fgr " << AngleDeg(R_gt, R_fgr) << " deg"
+                  << (equal ? "" : "  MISMATCH") << std::endl;
+
+        Bench("tims_reference", clique_size, num_tims, iterations, [&]() {
+            ref_tims = ReferenceTims(src, &ref_map);
+        });
+        Bench("tims_blocked", clique_size, num_tims, iterations, [&]() {
+            teaser::RobustRegistrationSolver::computeTIMs(src, nullptr, Formulation::COMPLETE, &clique_tims, &map);
+        });
+        Bench("gnc_reference", clique_size, num_tims, iterations, [&]() {
+            ReferenceGncTls(src_tims, dst_tims, params, &R_ref, &inliers_ref);
+        });
+        Bench("gnc_workspace", clique_size, num_tims, iterations, [&]() {
+            gnc_solver.solveForRotation(src_tims, dst_tims, &R_gnc, &inliers_gnc);
+        });
+        Bench("fgr_reference", clique_size, num_tims, iterations, [&]() {
+            ReferenceFgr(src_tims, dst_tims, params, &R_fgr_ref, &inliers_fgr_ref);
+        });
+        Bench("fgr_workspace", clique_size, num_tims, iterations, [&]() {
+            fgr_solver.solveForRotation(src_tims, dst_tims, &R_fgr, &inliers_fgr);
+        });
+    }
+    if (mismatches > 0) {
+        std::cout << mismatches << " mismatches against the reference loops" << std::endl;
+        return 1;
+    }
+    return 0;
+}
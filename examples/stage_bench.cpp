@@ -0,0 +1,226 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <Eigen/Geometry>
+#include "utils/config.h"
+#include "utils/synthetic.h"
+#include "utils/memory.h"
+#include "front_end/gem/ellipsoid.h"
+#include "front_end/gem/gem_matching.h"
+#include "front_end/gem/clustering.h"
+#include "back_end/pagor/registration.h"
+#include "back_end/pagor/geo_verify.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+using namespace g3reg;
+
+// exposes the association of the pyramid solver so that buildGraphs can run on its own
+class GraphBuilder : public pagor::PyramidRegistrationSolver {
+public:
+    GraphBuilder(const teaser::RobustRegistrationSolver::Params &params, int num_graphs)
+            : PyramidRegistrationSolver(params, num_graphs) {}
+
+    void setAssociation(const clique_solver::Association &A) {
+        A_ = A;
+    }
+
+    const clique_solver::Graph &graph(int level) const {
+        return inlier_graphs_[level];
+    }
+};
+
+/**
+ * Run setup then op for warmup + iterations rounds, only op is timed.
+ * Reports the median time per op, the items processed per second and the heap allocations per op, the latter
+ * only when built with G3REG_COUNT_ALLOCS.
+ */
+void bench(const std::string &name, double items, int iterations, const std::function<void()> &setup,
+           const std::function<void()> &op) {
+    std::vector<double> ns;
+    size_t allocs = 0, bytes = 0;
+    for (int i = 0; i <= iterations; i++) {
+        setup();
+        HeapCounters before = HeapCounters::read();
+        robot_utils::TicToc timer;
+        op();
+        double ms = timer.toc();
+        if (i == 0) {
+            continue; // warmup
+        }
+        ns.push_back(ms * 1e6);
+        HeapCounters after = HeapCounters::read();
+        allocs += after.allocs - before.allocs;
+        bytes += after.alloc_bytes - before.alloc_bytes;
+    }
+    std::sort(ns.begin(), ns.end());
+    double median = ns[ns.size() / 2];
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(14) << median << std::setw(10) << items << std::setprecision(3) << std::setw(14)
+              << items / (median * 1e-9) / 1e6 << std::setprecision(0) << std::setw(12)
+              << double(allocs) / iterations << std::setprecision(1) << std::setw(12)
+              << double(bytes) / iterations / 1024 << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: stage_bench config_file [iterations] [num_corrs]" << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 10;
+    int num_corrs = argc > 3 ? std::stoi(argv[3]) : 1000;
+    InitGLOG(config_path, nullptr);
+    config.load_config(config_path);
+
+    // fixtures: two scans of the same street 6 m apart, fixed seeds
+    SyntheticScene scene;
+    Eigen::Matrix4d src_pose = StreetPose(0, 0, 0), tgt_pose = StreetPose(6, 0.5, 8);
+    Eigen::Matrix4d T_gt = tgt_pose.inverse() * src_pose;
+    pcl::PointCloud<pcl::PointXYZ>::Ptr src_cloud = scene.scan(src_pose, LidarParams(), 1);
+    pcl::PointCloud<pcl::PointXYZ>::Ptr tgt_cloud = scene.scan(tgt_pose, LidarParams(), 2);
+
+    double t_ground;
+    pcl::PointCloud<pcl::PointXYZ> ground;
+    pcl::PointCloud<pcl::PointXYZ>::Ptr nonground(new pcl::PointCloud<pcl::PointXYZ>);
+    travel::estimateGround(*src_cloud, ground, *nonground, t_ground);
+
+    EllipsoidMatcher matcher(src_cloud, tgt_cloud);
+    std::vector<clique_solver::GraphVertex::Ptr> src_nodes, tgt_nodes;
+    clique_solver::Association A = matcher.matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes);
+    std::vector<QuadricFeature::Ptr> src_ellipsoids = matcher.getSrcEllipsoids();
+    std::vector<QuadricFeature::Ptr> tgt_ellipsoids = matcher.getTgtEllipsoids();
+    // ground-truth consistent associations, i.e. what a max clique hands to the tf solver
+    std::vector<int> inlier_rows;
+    for (int i = 0; i < A.rows(); i++) {
+        Eigen::Vector3d p = T_gt.block<3, 3>(0, 0) * src_nodes[A(i, 0)]->centroid + T_gt.block<3, 1>(0, 3);
+        if ((p - tgt_nodes[A(i, 1)]->centroid).norm() < 1.0) {
+            inlier_rows.push_back(i);
+        }
+    }
+    clique_solver::Association A_inliers(inlier_rows.size(), 2);
+    for (size_t i = 0; i < inlier_rows.size(); i++) {
+        A_inliers.row(i) = A.row(inlier_rows[i]);
+    }
+
+    // GEM descriptors, the square roots of ellipsoid eigenvalues as in the wasserstein association
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> size_dist(0.2, 5.0), jitter(-0.05, 0.05);
+    std::vector<GEM::Ptr> src_gems, tgt_gems;
+    for (int i = 0; i < config.num_clusters + config.num_planes + config.num_lines; i++) {
+        Eigen::Vector3d desc(size_dist(rng), size_dist(rng), size_dist(rng));
+        src_gems.push_back(GEM::Ptr(new GEM(desc)));
+        tgt_gems.push_back(GEM::Ptr(new GEM(desc + Eigen::Vector3d(jitter(rng), jitter(rng), jitter(rng)))));
+    }
+
+    // point correspondences with 90% outliers for the consistency graphs
+    clique_solver::VertexInfo point_info = config.vertex_info;
+    point_info.type = clique_solver::VertexType::POINT;
+    CorrespondenceParams corr_params;
+    corr_params.seed = 4;
+    corr_params.num_corrs = num_corrs;
+    SyntheticCorrespondences corrs = GenerateCorrespondences(*src_cloud, corr_params);
+    std::vector<clique_solver::GraphVertex::Ptr> src_points, tgt_points;
+    clique_solver::Association A_points(num_corrs, 2);
+    for (int i = 0; i < num_corrs; i++) {
+        src_points.push_back(clique_solver::create_vertex(corrs.src.row(i).transpose(), point_info));
+        tgt_points.push_back(clique_solver::create_vertex(corrs.tgt.row(i).transpose(), point_info));
+        A_points(i, 0) = i;
+        A_points(i, 1) = i;
+    }
+    teaser::RobustRegistrationSolver::Params graph_params;
+    graph_params.noise_bound = point_info.noise_bound_vec[0];
+    std::unique_ptr<GraphBuilder> builder;
+    auto new_builder = [&]() {
+        builder.reset(new GraphBuilder(graph_params, point_info.noise_bound_vec.size()));
+        builder->setAssociation(A_points);
+    };
+    new_builder();
+    builder->buildGraphs(src_points, tgt_points);
+    clique_solver::Graph graph = builder->graph(0);
+
+    std::vector<Eigen::Matrix4d> candidates;
+    for (int i = 0; i < std::max(1, config.num_graphs); i++) {
+        Eigen::Matrix4d candidate = T_gt;
+        candidate.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.02 * i, Eigen::Vector3d::UnitZ()).toRotationMatrix() *
+                                      candidate.block<3, 3>(0, 0);
+        candidates.push_back(candidate);
+    }
+
+    std::cout << "Fixtures: " << src_cloud->size() << "/" << tgt_cloud->size() << " points, " << nonground->size()
+              << " non-ground, " << A.rows() << " GEM associations (" << A_inliers.rows() << " inliers), "
+              << num_corrs << " point correspondences, graph edges " << graph.numEdges() << std::endl;
+    std::cout << std::left << std::setw(18) << "stage" << std::right << std::setw(14) << "ns/op" << std::setw(10)
+              << "items" << std::setw(14) << "Mitems/s" << std::setw(12) << "allocs/op" << std::setw(12) << "KiB/op"
+              << std::endl;
+    if (!HeapCounters::enabled()) {
+        std::cout << "allocs/op and KiB/op need -DG3REG_COUNT_ALLOCS=ON" << std::endl;
+    }
+
+    auto no_setup = []() {};
+    VoxelMap voxel_map;
+    bench("voxelize", src_cloud->size(), iterations, [&]() { voxel_map.clear(); }, [&]() {
+        cutCloud(*src_cloud, FeatureType::None, config.plane_resolution, voxel_map);
+        for (auto &voxel: voxel_map) {
+            voxel.second->parse();
+        }
+    });
+    bench("travel_ground", src_cloud->size(), iterations, no_setup, [&]() {
+        double t;
+        pcl::PointCloud<pcl::PointXYZ> g, ng;
+        travel::estimateGround(*src_cloud, g, ng, t);
+    });
+    bench("dcvc_cluster", nonground->size(), iterations, no_setup, [&]() {
+        std::vector<ClusterFeature::Ptr> clusters;
+        DCVC::Cluster(nonground, clusters, false);
+    });
+    bench("extract_feature", src_cloud->size(), iterations, no_setup, [&]() {
+        PLCExtractor extractor;
+        std::vector<LineFeature::Ptr> lines;
+        std::vector<SurfaceFeature::Ptr> planes;
+        std::vector<ClusterFeature::Ptr> clusters;
+        extractor.ExtractFeature(src_cloud, lines, planes, clusters);
+    });
+    bench("matching_gems", double(src_gems.size()) * tgt_gems.size(), iterations, no_setup, [&]() {
+        MatchingGEMs(src_gems, tgt_gems, config.assoc_topk);
+    });
+    bench("build_graphs", double(num_corrs) * (num_corrs - 1) / 2, iterations, new_builder, [&]() {
+        builder->buildGraphs(src_points, tgt_points);
+    });
+    bench("max_clique", graph.numEdges(), iterations, no_setup, [&]() {
+        clique_solver::MaxCliqueSolver::Params clique_params;
+        clique_solver::MaxCliqueSolver solver(clique_params);
+        solver.findMaxClique(graph);
+    });
+    // what pagor does per level: flatten into buffers kept across calls and hand them to PMC
+    std::vector<long long> csr_offsets;
+    std::vector<int> csr_neighbors;
+    bench("max_clique_csr", graph.numEdges(), iterations, no_setup, [&]() {
+        clique_solver::MaxCliqueSolver::Params clique_params;
+        clique_solver::MaxCliqueSolver solver(clique_params);
+        graph.toCSR(&csr_offsets, &csr_neighbors);
+        solver.findMaxClique(csr_offsets, csr_neighbors);
+    });
+    bench("gnc_quadrics_se3", A_inliers.rows(), iterations, no_setup, [&]() {
+        gtsam::gncQuadricsSE3(src_ellipsoids, tgt_ellipsoids, A_inliers);
+    });
+    bench("gnc_tls_fused", A_inliers.rows(), iterations, no_setup, [&]() {
+        gtsam::fusedGncQuadricsSE3(src_ellipsoids, tgt_ellipsoids, A_inliers);
+    });
+    bench("geometry_verify", candidates.size(), iterations, no_setup, [&]() {
+        GeometryVerify(matcher.getSrcVoxels(), matcher.getTgtVoxels(), candidates);
+    });
+
+    // the fused solver has to land where the factor graph does
+    Eigen::Matrix4d T_graph = gtsam::gncQuadricsSE3(src_ellipsoids, tgt_ellipsoids, A_inliers);
+    Eigen::Matrix4d T_fused = gtsam::fusedGncQuadricsSE3(src_ellipsoids, tgt_ellipsoids, A_inliers);
+    Eigen::Matrix4d diff = T_graph.inverse() * T_fused;
+    std::cout << "gnc_tls_fused vs gnc_quadrics_se3: "
+              << std::acos(std::min(1.0, std::max(-1.0, (diff.block<3, 3>(0, 0).trace() - 1) / 2))) * 180.0 / M_PI
+              << " deg, " << diff.block<3, 1>(0, 3).norm() << " m" << std::endl;
+    return 0;
+}
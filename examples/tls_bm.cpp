@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "back_end/teaser/registration.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+
+typedef Eigen::Matrix<bool, 1, Eigen::Dynamic> Inliers;
+typedef void (teaser::ScalarTLSEstimator::*EstimateFn)(const Eigen::RowVectorXd &, const Eigen::RowVectorXd &,
+                                                        double *, Inliers *);
+
+// median time in ms of estimator.*fn over iterations runs after one warmup
+double Median(teaser::ScalarTLSEstimator &estimator, EstimateFn fn, const Eigen::RowVectorXd &X,
+              const Eigen::RowVectorXd &ranges, int iterations) {
+    std::vector<double> ms;
+    double estimate;
+    Inliers inliers(1, X.cols());
+    for (int i = 0; i <= iterations; i++) {
+        robot_utils::TicToc timer;
+        (estimator.*fn)(X, ranges, &estimate, &inliers);
+        if (i > 0) {
+            ms.push_back(timer.toc());
+        }
+    }
+    std::sort(ms.begin(), ms.end());
+    return ms[ms.size() / 2];
+}
+
+/**
+ * Compare ScalarTLSEstimator::estimate_radix against estimate on measurements of one value with outliers, the
+ * setting of the TLS scale and translation solvers. Both must return the same estimate and inliers.
+ */
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+    double outlier_ratio = argc > 2 ? std::stod(argv[2]) : 0.6;
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> inlier_dist(1.5, 0.05);
+    std::uniform_real_distribution<double> outlier_dist(-50, 50), range_dist(0.05, 0.3), unit(0, 1);
+    int mismatches = 0;
+    std::cout << std::left << std::setw(10) << "N" << std::right << std::setw(14) << "sort_ms" << std::setw(14)
+              << "radix_ms" << std::setw(10) << "speedup" << std::setw(10) << "equal" << std::endl;
+    for (int N: {100, 300, 1000, 3000, 10000, 30000, 100000}) {
+        Eigen::RowVectorXd X(N), ranges(N);
+        for (int i = 0; i < N; i++) {
+            X(i) = unit(rng) < outlier_ratio ? outlier_dist(rng) : inlier_dist(rng);
+            ranges(i) = range_dist(rng);
+        }
+
+        teaser::ScalarTLSEstimator estimator;
+        double estimate_sort, estimate_radix;
+        Inliers inliers_sort(1, N), inliers_radix(1, N);
+        estimator.estimate(X, ranges, &estimate_sort, &inliers_sort);
+        estimator.estimate_radix(X, ranges, &estimate_radix, &inliers_radix);
+        bool equal = estimate_sort == estimate_radix && inliers_sort == inliers_radix;
+        mismatches += !equal;
+
+        int repeats = std::max(3, iterations * 1000 / N);
+        double sort_ms = Median(estimator, &teaser::ScalarTLSEstimator::estimate, X, ranges, repeats);
+        double radix_ms = Median(estimator, &teaser::ScalarTLSEstimator::estimate_radix, X, ranges, repeats);
+        std::cout << std::left << std::setw(10) << N << std::right << std::fixed << std::setprecision(4)
+                  << std::setw(14) << sort_ms << std::setw(14) << radix_ms << std::setprecision(2) << std::setw(10)
+                  << sort_ms / radix_ms << std::setw(10) << (equal ? "yes" : "NO") << std::endl;
+        if (!equal) {
+            std::cout << std::setprecision(12) << "  estimate " << estimate_sort << " vs " << estimate_radix
+                      << ", inliers " << inliers_sort.count() << " vs " << inliers_radix.count() << std::endl;
+        }
+    }
+    if (mismatches > 0) {
+        std::cout << mismatches << " sizes where estimate_radix differs from estimate" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "utils/config.h"
+#include "utils/synthetic.h"
+#include "back_end/reglib.h"
+#include "robot_utils/tic_toc.h"
+
+using namespace std;
+using namespace g3reg;
+
+struct ModeStats {
+    int success = 0;
+    double time_ms = 0, graph_ms = 0, clique_ms = 0, tf_solver_ms = 0, verify_ms = 0;
+};
+
+/**
+ * Compare the 6-DoF PAGOR path with the yaw-only mode on synthetic street pairs related by a yaw, a translation
+ * and a small roll and pitch, as between loop closure scans of a ground vehicle. Reports the throughput, the stage
+ * times and the success rate (rot_thresh and trans_thresh of the config) of both.
+ */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: yaw_bm config_file [num_pairs] [outlier_ratio] [num_corrs] [max_tilt_deg]" << std::endl;
+        return -1;
+    }
+    std::string config_path = config.project_path + "/" + argv[1];
+    int num_pairs = argc > 2 ? std::stoi(argv[2]) : 50;
+    double outlier_ratio = argc > 3 ? std::stod(argv[3]) : 0.9;
+    int num_corrs = argc > 4 ? std::stoi(argv[4]) : 1000;
+    double max_tilt = argc > 5 ? std::stod(argv[5]) : 1.0;
+    InitGLOG(config_path, nullptr);
+    config.load_config(config_path);
+    Config base_config = config;
+    base_config.back_end = "pagor";
+
+    SyntheticScene scene;
+    pcl::PointCloud<pcl::PointXYZ>::Ptr src_cloud = scene.scan(StreetPose(0, 0, 0));
+    PointRows src_points(src_cloud->size(), 3);
+    for (size_t i = 0; i < src_cloud->size(); i++) {
+        src_points.row(i) << src_cloud->points[i].x, src_cloud->points[i].y, src_cloud->points[i].z;
+    }
+
+    std::vector<std::string> modes = {"6dof", "yaw_only"};
+    std::vector<ModeStats> stats(modes.size());
+    for (int pair = 0; pair < num_pairs; pair++) {
+        CorrespondenceParams corr_params;
+        corr_params.seed = pair;
+        corr_params.num_corrs = num_corrs;
+        corr_params.outlier_ratio = outlier_ratio;
+        corr_params.max_rotation = 180;
+        corr_params.max_tilt = max_tilt;
+        pcl::PointCloud<pcl::PointXYZ> tgt_cloud;
+        SyntheticCorrespondences corrs = GenerateCorrespondences(*src_cloud, corr_params, &tgt_cloud);
+        PointRows tgt_points(tgt_cloud.size(), 3);
+        for (size_t i = 0; i < tgt_cloud.size(); i++) {
+            tgt_points.row(i) << tgt_cloud.points[i].x, tgt_cloud.points[i].y, tgt_cloud.points[i].z;
+        }
+
+        for (size_t m = 0; m < modes.size(); m++) {
+            Config run_config = base_config;
+            run_config.yaw_only = modes[m] == "yaw_only";
+            robot_utils::TicToc timer;
+            FRGresult result = SolveFromCorresp(corrs.src, corrs.tgt, src_points, tgt_points, run_config);
+            double time_ms = timer.toc();
+
+            Eigen::Matrix4d err = corrs.T.inverse() * result.tf;
+            double rot_err = std::acos(std::min(1.0, std::max(-1.0, (err.block<3, 3>(0, 0).trace() - 1) / 2))) *
+                             180.0 / M_PI;
+            double trans_err = err.block<3, 1>(0, 3).norm();
+            ModeStats &s = stats[m];
+            s.success += result.valid && rot_err < base_config.rot_thresh && trans_err < base_config.trans_thresh;
+            s.time_ms += time_ms;
+            s.graph_ms += result.graph_time;
+            s.clique_ms += result.clique_time;
+            s.tf_solver_ms += result.tf_solver_time;
+            s.verify_ms += result.verify_time;
+        }
+    }
+
+    std::cout << num_pairs << " pairs, " << num_corrs << " correspondences, outlier ratio " << outlier_ratio
+              << ", roll and pitch up to " << max_tilt << " deg" << std::endl;
+    std::cout << std::left << std::setw(10) << "mode" << std::right << std::setw(10) << "pairs/s" << std::setw(10)
+              << "success" << std::setw(10) << "total_ms" << std::setw(10) << "graph_ms" << std::setw(11)
+              << "clique_ms" << std::setw(8) << "tf_ms" << std::setw(11) << "verify_ms" << std::endl;
+    for (size_t m = 0; m < modes.size(); m++) {
+        const ModeStats &s = stats[m];
+        std::cout << std::left << std::setw(10) << modes[m] << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << num_pairs * 1e3 / s.time_ms << std::setw(10) << double(s.success) / num_pairs
+                  << std::setprecision(3) << std::setw(10) << s.time_ms / num_pairs << std::setw(10)
+                  << s.graph_ms / num_pairs << std::setw(11) << s.clique_ms / num_pairs << std::setw(8)
+                  << s.tf_solver_ms / num_pairs << std::setw(11) << s.verify_ms / num_pairs << std::endl;
+    }
+    return 0;
+}
@@ -5,9 +5,9 @@
 #include <string>
 #include <vector>
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
-#include <igraph/igraph.h>
 #include <pcl/common/transforms.h>
 #include <pcl/common/io.h>
 #include "front_end/gem/ellipsoid.h"
@@ -19,6 +19,9 @@ namespace mac_reg {
     public:
         bool use_sc2;
 
+        // symmetric compatibility graph in CSR form, the column indices of every row are sorted
+        typedef Eigen::SparseMatrix<float, Eigen::RowMajor> SpGraph;
+
         typedef struct {
             int src_index;
             int des_index;
@@ -40,12 +43,15 @@ namespace mac_reg {
             int true_num;
         } Vote_exp;
 
+        // bounds of the node-guided clique search, every node keeps its heaviest clique found within them. A bound
+        // of 0 is no bound, with none the search is exhaustive and matches the old per-node selection, but it can
+        // take minutes on large dense graphs
         typedef struct {
-            int clique_index;
-            int clique_size;
-            float clique_weight;
-            int clique_num;
-        } node_cliques;
+            int min_clique_size;
+            int max_branches;   // branch-and-bound expansions per node after the greedy clique
+            int max_cliques;    // distinct cliques kept as hypotheses, the heaviest first
+            double time_limit;  // ms for the whole search, nodes still running keep their greedy clique
+        } CliqueSearchParams;
 
         typedef struct {
             int index;
@@ -54,9 +60,13 @@ namespace mac_reg {
 
         std::vector<Corre_3DMatch> correspondence;
 
+        CliqueSearchParams clique_params = {3, 64, 1000, 1000.0};
+
     public:
         MaximalCliqueReg(bool use_sc2) : use_sc2(use_sc2) {}
 
+        MaximalCliqueReg(bool use_sc2, const CliqueSearchParams &params) : use_sc2(use_sc2), clique_params(params) {}
+
         MaximalCliqueReg(const std::string &corr_path, bool use_sc2) : use_sc2(use_sc2) {
 
             FILE *corr;
@@ -83,14 +93,14 @@ namespace mac_reg {
 
         Eigen::Matrix4d run();
 
-        Eigen::MatrixXf Graph_construction(std::vector<Corre_3DMatch> &correspondence, bool sc2);
+        SpGraph Graph_construction(std::vector<Corre_3DMatch> &correspondence, bool sc2);
 
         void post_refinement(pcl::PointCloud<pcl::PointXYZ>::Ptr &src_corr_pts,
                              pcl::PointCloud<pcl::PointXYZ>::Ptr &des_corr_pts,
                              Eigen::Matrix4d &initial, double &best_score, double inlier_thresh, int iterations,
                              const std::string &metric);
 
-        double Distance(pcl::PointXYZ &A, pcl::PointXYZ &B);
+        double Distance(const pcl::PointXYZ &A, const pcl::PointXYZ &B);
 
         static bool compare_vote_score(const Vote &v1, const Vote &v2) {
             return v1.score > v2.score;
@@ -100,16 +110,25 @@ namespace mac_reg {
             return v1.degree > v2.degree;
         }
 
+        /**
+         * Weighted clustering coefficient of every node, the per-node reductions run in parallel without locks.
+         * @param triangle_weights sum of cbrt(w_ia * w_ib * w_ab) over the triangles (i, a, b) of each node
+         * @return the coefficients, 0 for nodes with degree < 2
+         */
+        Eigen::VectorXd clustering_coefficients(const SpGraph &Graph, Eigen::VectorXd &triangle_weights);
+
         double OTSU_thresh(Eigen::VectorXd values);
 
-        void
-        find_largest_clique_of_node(Eigen::MatrixXf &Graph, igraph_vector_ptr_t *cliques,
-                                    std::vector<Corre_3DMatch> &correspondence,
-                                    node_cliques *result, std::vector<int> &remain, int num_node, int est_num);
+        /**
+         * Heaviest clique containing each active node, searched greedily and then by a bounded branch and bound
+         * instead of enumerating all maximal cliques. Only edges between active nodes are used.
+         * @return distinct cliques with sorted members, at most clique_params.max_cliques of them
+         */
+        std::vector<std::vector<int>> node_guided_cliques(const SpGraph &Graph, const std::vector<char> &node_active);
 
         double
-        evaluation_trans(std::vector<Corre_3DMatch> &Match, pcl::PointCloud<pcl::PointXYZ>::Ptr &src_corr_pts,
-                         pcl::PointCloud<pcl::PointXYZ>::Ptr &des_corr_pts, double weight_thresh,
+        evaluation_trans(const std::vector<int> &clique, const Eigen::Matrix3Xd &src_pts,
+                         const Eigen::Matrix3Xd &des_pts, double weight_thresh,
                          Eigen::Matrix4d &trans, double metric_thresh);
 
         void weight_SVD(pcl::PointCloud<pcl::PointXYZ>::Ptr &src_pts, pcl::PointCloud<pcl::PointXYZ>::Ptr &des_pts,
@@ -22,4 +22,10 @@ std::pair<bool, Eigen::Matrix4d> PlaneVerify(typename pcl::PointCloud<pcl::Point
                                              typename pcl::PointCloud<pcl::PointXYZ>::Ptr tgt_cloud,
                                              const std::vector<Eigen::Matrix4d> &candidates);
 
+/**
+ * Restrict candidates to x, y, z and yaw for the yaw-only mode: roll and pitch are dropped and the yaw is read
+ * from the rotated x axis. The order is kept, candidate i is still the one of level i.
+ */
+std::vector<Eigen::Matrix4d> ProjectToYaw(const std::vector<Eigen::Matrix4d> &candidates);
+
 #endif //SRC_GEO_VERIFY_H
@@ -19,17 +19,12 @@ namespace pagor {
                 : RobustRegistrationSolver(
                 params) {
             num_graphs_ = num_graphs;
-            // initialize the inlier_graphs_ and max_cliques_
+            // initialize the inlier_graphs_ and max_cliques_, CLIPPER reads the edges as CSR too, so no level keeps
+            // a dense adjacency matrix
             for (int i = 0; i < num_graphs_; ++i) {
                 clique_solver::Graph graph;
                 graph.clear();
-                if (params.inlier_selection_mode == teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE::CLIPPER ||
-                    params.inlier_selection_mode ==
-                    teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE::PYCLIPPER) {
-                    graph.setType(true);
-                } else {
-                    graph.setType(false);
-                }
+                graph.setType(false);
                 inlier_graphs_.push_back(graph);
                 max_cliques_.push_back(std::vector<int>());
             }
@@ -52,10 +47,26 @@ namespace pagor {
                                               const std::vector<clique_solver::GraphVertex::Ptr> &v2,
                                               const std::vector<int> &max_clique, const int level);
 
+        /**
+         * 4-DoF transform of the yaw-only mode. The yaw is the GNC-TLS rotation between the horizontal
+         * components of the clique TIMs, the translation the TLS translation after that yaw.
+         */
+        void solveTransformYaw(const std::vector<clique_solver::GraphVertex::Ptr> &v1,
+                               const std::vector<clique_solver::GraphVertex::Ptr> &v2,
+                               const std::vector<int> &max_clique, const int level);
+
         void solveTransformGMM(const std::vector<g3reg::QuadricFeature::Ptr> &v1,
                                const std::vector<g3reg::QuadricFeature::Ptr> &v2, const std::vector<int> &max_clique,
                                const int level, Eigen::Matrix4d T_init = Eigen::Matrix4d::Identity());
 
+        /**
+         * Solve the transforms of all levels together (config tf_batch). Levels with equal cliques are solved once,
+         * the quadric terms are built once for all levels, and each level starts from the solution of the level
+         * whose clique overlaps it most. Levels of the same depth in that warm-start tree run in parallel.
+         */
+        void solveTransformsBatched(const std::vector<clique_solver::GraphVertex::Ptr> &v1,
+                                    const std::vector<clique_solver::GraphVertex::Ptr> &v2);
+
         void buildGraphs(const std::vector<clique_solver::GraphVertex::Ptr> &v1,
                          const std::vector<clique_solver::GraphVertex::Ptr> &v2);
 
@@ -74,6 +85,10 @@ namespace pagor {
         std::vector<std::vector<int>> max_cliques_;
         clique_solver::Association A_;
         std::vector<g3reg::QuadricFeature::Ptr> src_features_, dst_features_;
+        teaser::RotationWorkspace<2> yaw_workspace_;
+        // CSR buffers handed to the max clique solver, reused by every level
+        std::vector<long long> csr_offsets_;
+        std::vector<int> csr_neighbors_;
     };
 }
 
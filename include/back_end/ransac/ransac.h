@@ -19,15 +19,37 @@ namespace ransac {
         double inlier_threshold;
         int min_inliers;
         double inliers_to_end;
+        // "full" scores every hypothesis against all associations,
+        // "preemptive" scores hypotheses in blocks and drops the worse half after every block
+        std::string scoring;
+        int preemptive_hypotheses;
+        int preemptive_block;
 
         RansacParams() {
             max_iterations = 1000;
             inlier_threshold = 0.6;
             min_inliers = 0;
             inliers_to_end = 0.5;
+            scoring = "full";
+            preemptive_hypotheses = 500;
+            preemptive_block = 100;
         }
     };
 
+    Eigen::Matrix4d
+    ransac_registration(const std::vector<Eigen::Vector3d> &src_points, const std::vector<Eigen::Vector3d> &tgt_points,
+                        const Eigen::MatrixX2i &associations, RansacParams params);
+
+    /**
+     * Preemptive RANSAC (Nister, ICCV 2003). Hypotheses are generated in rounds of preemptive_hypotheses,
+     * scored on consecutive blocks of a random permutation of the associations and halved after every block,
+     * so only the winner of each round is scored against all associations.
+     */
+    Eigen::Matrix4d
+    preemptive_ransac_registration(const std::vector<Eigen::Vector3d> &src_points,
+                                   const std::vector<Eigen::Vector3d> &tgt_points,
+                                   const Eigen::MatrixX2i &associations, RansacParams params);
+
     void solve(const std::vector<clique_solver::GraphVertex::Ptr> &src_nodes,
                const std::vector<clique_solver::GraphVertex::Ptr> &tgt_nodes,
                const clique_solver::Association &A, FRGresult &result);
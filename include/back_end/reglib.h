@@ -12,14 +12,18 @@
 #include <pcl/point_cloud.h>
 
 namespace g3reg {
+    // N x 3 points, row-major like numpy arrays so that they are read in place; other layouts are copied on each call
+    typedef Eigen::Ref<const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>, 0,
+            Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>> PointsRef;
+
     FRGresult GlobalRegistration(const pcl::PointCloud<pcl::PointXYZ>::Ptr &src_cloud,
                                  const pcl::PointCloud<pcl::PointXYZ>::Ptr &tgt_cloud,
                                  std::tuple<int, int, int> pair_info = std::make_tuple(0, 0, 0));
 
-    FRGresult SolveFromCorresp(const Eigen::MatrixX3d &src_corresp,
-                               const Eigen::MatrixX3d &tgt_corresp,
-                               const Eigen::MatrixX3d &src_cloud,
-                               const Eigen::MatrixX3d &tgt_cloud,
+    FRGresult SolveFromCorresp(const PointsRef &src_corresp,
+                               const PointsRef &tgt_corresp,
+                               const PointsRef &src_cloud,
+                               const PointsRef &tgt_cloud,
                                const Config &config_custom = config);
 }
 
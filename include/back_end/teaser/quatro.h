@@ -46,6 +46,7 @@ namespace quatro {
         bool using_pre_estimated_RyRx_ = false;
         Eigen::Matrix3d estimated_RyRx_ = Eigen::Matrix3d::Identity();
         double cost_;
+        teaser::RotationWorkspace<2> workspace_;
     };
 
 }
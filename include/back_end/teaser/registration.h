@@ -11,6 +11,7 @@
 #include <memory>
 #include <vector>
 #include <tuple>
+#include <cstdint>
 
 #include <Eigen/Core>
 #include <Eigen/SVD>
@@ -37,6 +38,8 @@ namespace teaser {
         std::vector<Eigen::Matrix4d> candidates;
         Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> inliers;
         double clique_time, tf_solver_time, graph_time;
+        std::vector<double> level_times; // tf solving of each pyramid level in ms, 0 for levels reusing another
+        std::vector<double> clique_level_times; // max clique of each pyramid level in ms
     };
 
     /**
@@ -130,6 +133,34 @@ namespace teaser {
          */
         void estimate_tiled(const Eigen::RowVectorXd &X, const Eigen::RowVectorXd &ranges, const int &s,
                             double *estimate, Eigen::Matrix<bool, 1, Eigen::Dynamic> *inliers);
+
+        /**
+         * Same estimate as estimate() without the comparison sort and the per-call allocations. The interval
+         * bounds are packed into order-preserving 64-bit keys and radix sorted, the sweep runs over scratch
+         * buffers kept by the estimator, and the costs of all bounds are evaluated in one vectorized pass.
+         * The running sums are accumulated in the same order as estimate(), so both give identical results
+         * unless two bounds are equal, whose order std::sort leaves unspecified anyway.
+         * @param X Available measurements
+         * @param ranges Maximum admissible errors for measurements X
+         * @param estimate (output) pointer to a double holding the estimate
+         * @param inliers (output) pointer to a Eigen row vector of inliers
+         */
+        void estimate_radix(const Eigen::RowVectorXd &X, const Eigen::RowVectorXd &ranges, double *estimate,
+                            Eigen::Matrix<bool, 1, Eigen::Dynamic> *inliers);
+
+    private:
+        // an interval bound, id = i + 1 opens interval i and id = -i - 1 closes it
+        struct Bound {
+            uint64_t key;
+            int64_t id;
+        };
+
+        void sortBounds(size_t n);
+
+        // std::vector keeps its capacity when the size changes, Eigen arrays reallocate
+        std::vector<Bound> bounds_, bounds_scratch_;
+        std::vector<size_t> histograms_;
+        std::vector<double> weights_, x_hat_, cardinal_, sum_xi_, sum_xi_square_, ranges_sum_, x_cost_;
     };
 
     /**
@@ -217,6 +248,71 @@ namespace teaser {
         ScalarTLSEstimator tls_estimator_;
     };
 
+    /**
+     * Buffers and fixed-size kernels of the GNC rotation loops, for D = 3 (TEASER) and D = 2 (Quatro yaw).
+     * The weighted correlation matrix is accumulated as a DxD sum over the correspondences instead of
+     * X * W.asDiagonal() * Y^T, and the residuals, weights and cost are updated over buffers that keep their
+     * capacity between calls, so a solve allocates nothing once the workspace has seen the largest clique.
+     */
+    template<int D>
+    class RotationWorkspace {
+    public:
+        typedef Eigen::Matrix<double, D, D> MatrixD;
+        typedef Eigen::Matrix<double, D, Eigen::Dynamic> MatrixDX;
+        typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArray;
+
+        /**
+         * Weighted orthogonal Procrustes, the same rotation as gtsam::svdRot / svdRot2d. Correspondences with
+         * zero weight are skipped.
+         */
+        static MatrixD weightedRotation(const MatrixDX &src, const MatrixDX &dst, const double *weights);
+
+        // squared residuals |dst_j - R src_j|^2 into residuals_sq
+        static void residuals(const MatrixDX &src, const MatrixDX &dst, const MatrixD &rotation,
+                              double *residuals_sq);
+
+        /**
+         * GNC-TLS as in GNCTLSRotationSolver. Besides the cost convergence rule, it stops as soon as the weights
+         * are binary and equal to the ones the rotation was solved with: every further iteration would reproduce
+         * the same rotation, weights and cost.
+         * @param noise_bound_sq squared noise bound of the residuals
+         * @param rotation (output) the rotation
+         * @param cost (output) the TLS cost at termination
+         * @return the number of iterations run
+         */
+        size_t solveGncTls(const MatrixDX &src, const MatrixDX &dst, double noise_bound_sq, double gnc_factor,
+                           double cost_threshold, size_t max_iterations, MatrixD *rotation, double *cost);
+
+        // weights of the last solve, one per correspondence
+        Eigen::Map<const Eigen::RowVectorXd> weights() const {
+            return Eigen::Map<const Eigen::RowVectorXd>(weights_.data(), size_);
+        }
+
+        // scratch buffers of at least n entries for callers with their own loop, e.g. FGR
+        double *weightsBuffer(size_t n) {
+            reserve(n);
+            return weights_.data();
+        }
+
+        double *residualsBuffer(size_t n) {
+            reserve(n);
+            return residuals_sq_.data();
+        }
+
+    private:
+        void reserve(size_t n) {
+            size_ = n;
+            if (weights_.size() < n) {
+                weights_.resize(n);
+                next_weights_.resize(n);
+                residuals_sq_.resize(n);
+            }
+        }
+
+        size_t size_ = 0;
+        std::vector<double> weights_, next_weights_, residuals_sq_;
+    };
+
     /**
      * Base class for GNC-based rotation solvers
      */
@@ -247,6 +343,7 @@ namespace teaser {
     protected:
         Params params_;
         double cost_;
+        RotationWorkspace<3> workspace_;
     };
 
     /**
@@ -494,6 +591,24 @@ namespace teaser {
         computeTIMs(const Eigen::Matrix<double, 3, Eigen::Dynamic> &v,
                     Eigen::Matrix<int, 2, Eigen::Dynamic> *map);
 
+        /**
+         * Build the TIMs of a max clique without gathering its measurements or the unused pairs. The output
+         * is filled in parallel in blocks of columns that fit in the L1 cache, and its storage is reused when
+         * the size does not change.
+         * CHAIN: TIM k is v(clique[k+1]) - v(clique[k]), the last one closes the loop to clique[0], and map
+         * holds (clique[k+1], clique[k]).
+         * COMPLETE: the TIMs of all pairs of the clique in the order of computeTIMs(v, map), and map holds the
+         * positions (i, j) of each pair in the clique.
+         * @param v a 3-by-N matrix
+         * @param clique columns of v forming the clique, all columns in order if nullptr
+         * @param formulation chain or complete TIM graph
+         * @param tims (output) a 3-by-M matrix of TIMs
+         * @param map (output) a 2-by-M matrix of the measurements of each TIM, skipped if nullptr
+         */
+        static void computeTIMs(const Eigen::Matrix<double, 3, Eigen::Dynamic> &v, const std::vector<int> *clique,
+                                INLIER_GRAPH_FORMULATION formulation, Eigen::Matrix<double, 3, Eigen::Dynamic> *tims,
+                                Eigen::Matrix<int, 2, Eigen::Dynamic> *map);
+
         /**
          * Solve for scale, translation and rotation.
          *
@@ -13,6 +13,7 @@
 #include <boost/format.hpp>
 #include "utils/config.h"
 #include "datasets/dataloader.h"
+#include "datasets/pcd_reader.h"
 
 class ApolloData {
 public:
@@ -59,23 +60,15 @@ public:
         LOG(INFO) << "Load Apollo Dataset.";
     }
 
-    Eigen::Matrix4d getLidarPose(std::string dataset_root, int seq, int frame_id) {
-        if (lidar_poses.find(seq) == lidar_poses.end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else if (lidar_poses[seq].find(frame_id) == lidar_poses[seq].end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else {
-            return lidar_poses[seq][frame_id];
-        }
-        return lidar_poses[seq][frame_id];
+    std::string GetScanPath(std::string dataset_root, int seq, int i) {
+        std::string dir_name = apollo_data.apollo_sessions[seq];
+        return boost::str(boost::format("%s/%spcds/%d.pcd") % dataset_root % dir_name % i);
     }
 
     pcl::PointCloud<pcl::PointXYZ>::Ptr GetCloud(std::string dataset_root, int seq, int i) {
-        std::string dir_name = apollo_data.apollo_sessions[seq];
-        std::string file_name = boost::str(boost::format("%s/%spcds/%d.pcd") % dataset_root % dir_name % i);
-        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
-        if (pcl::io::loadPCDFile<pcl::PointXYZ>(file_name, *cloud) == -1) {
-            PCL_ERROR("Couldn't read file test_pcd.pcd \n");
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = g3reg::ReadPCDXYZ(GetScanPath(dataset_root, seq, i));
+        if (cloud == nullptr) {
+            cloud.reset(new pcl::PointCloud<pcl::PointXYZ>);
         }
         return cloud;
     }
@@ -83,29 +76,20 @@ public:
     void LoadLiDARPoses(std::string dataset_root, int seq) {
         std::string dir_name = apollo_data.apollo_sessions[seq];
         std::string file_name = boost::str(boost::format("%s/%sposes/gt_poses.txt") % dataset_root % dir_name);
-        std::ifstream file(file_name);
-        if (!file.is_open()) {
+        // num timestamp tx ty tz qx qy qz qw
+        PoseStore::LineParser parser = [](const char *line, int line_idx, int &frame_id, Eigen::Matrix4d &Twl) {
+            double v[9];
+            if (PoseStore::ParseNumbers(line, v, 9) < 9) {
+                return false;
+            }
+            frame_id = v[0];
+            Twl.block<3, 3>(0, 0) = Eigen::Quaterniond(v[8], v[5], v[6], v[7]).toRotationMatrix();
+            Twl.block<3, 1>(0, 3) = Eigen::Vector3d(v[2], v[3], v[4]);
+            return true;
+        };
+        if (!lidar_poses[seq].load(file_name, parser, g3reg::config.pose_cache)) {
             throw std::runtime_error("Could not open file");
         }
-        std::fstream f;
-        f.open(file_name, std::ios::in);
-        std::string line;
-        lidar_poses[seq] = std::map<int, Eigen::Matrix4d>();
-        while (std::getline(f, line)) {
-            std::stringstream ss(line);
-            int num;
-            double timestamp, tx, ty, tz, qx, qy, qz, qw;
-            ss >> num >> timestamp >> tx >> ty >> tz >> qx >> qy >> qz >> qw;
-            Eigen::Matrix4d Twl = Eigen::Matrix4d::Identity();
-            Eigen::Quaterniond q(qw, qx, qy, qz);
-            Eigen::Matrix3d R = q.toRotationMatrix();
-            Twl.block<3, 3>(0, 0) = R;
-            Twl(0, 3) = tx;
-            Twl(1, 3) = ty;
-            Twl(2, 3) = tz;
-            lidar_poses[seq][num] = Twl;
-        }
-        f.close();
     }
 };
 
@@ -0,0 +1,97 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_BIN_READER_H
+#define SRC_BIN_READER_H
+
+#include <cmath>
+#include <limits>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <glog/logging.h>
+#include "utils/mapped_file.h"
+
+namespace g3reg {
+
+    // one point of a KITTI/KITTI-360 velodyne scan as stored on disk
+    struct BinRecord {
+        float x, y, z, intensity;
+    };
+
+    // velodyne .bin scan mapped into memory, the records are read in place without a staging buffer
+    class BinScan {
+    public:
+        bool open(const std::string &path) {
+            return file_.open(path);
+        }
+
+        size_t size() const {
+            return file_.size() / sizeof(BinRecord);
+        }
+
+        const BinRecord *data() const {
+            return reinterpret_cast<const BinRecord *>(file_.data());
+        }
+
+        const BinRecord &operator[](size_t i) const {
+            return data()[i];
+        }
+
+        size_t bytes() const {
+            return file_.size();
+        }
+
+    private:
+        MappedFile file_;
+    };
+
+    /**
+     * Read the xyz of a velodyne scan in a single pass over the mapped file.
+     * Points whose range is outside [min_range, max_range] are dropped during the same pass.
+     * @return nullptr if the file cannot be opened
+     */
+    inline pcl::PointCloud<pcl::PointXYZ>::Ptr
+    ReadBinXYZ(const std::string &bin_path, double min_range = 0,
+               double max_range = std::numeric_limits<double>::infinity()) {
+        BinScan scan;
+        if (!scan.open(bin_path)) {
+            LOG(ERROR) << "Point Cloud File '" << bin_path << "' is not found!";
+            return nullptr;
+        }
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>());
+        size_t num_points = scan.size();
+        cloud->resize(num_points);
+        const BinRecord *records = scan.data();
+        pcl::PointXYZ *points = cloud->points.data();
+        size_t kept = 0;
+        if (min_range <= 0 && std::isinf(max_range)) {
+            for (size_t i = 0; i < num_points; i++) {
+                points[i].x = records[i].x;
+                points[i].y = records[i].y;
+                points[i].z = records[i].z;
+            }
+            kept = num_points;
+        } else {
+            float min_sq = min_range * min_range, max_sq = max_range * max_range;
+            for (size_t i = 0; i < num_points; i++) {
+                const BinRecord &r = records[i];
+                float range_sq = r.x * r.x + r.y * r.y + r.z * r.z;
+                if (range_sq >= min_sq && range_sq <= max_sq) {
+                    points[kept].x = r.x;
+                    points[kept].y = r.y;
+                    points[kept].z = r.z;
+                    kept++;
+                }
+            }
+        }
+        cloud->resize(kept);
+        cloud->width = kept;
+        cloud->height = 1;
+        return cloud;
+    }
+}
+
+#endif //SRC_BIN_READER_H
@@ -8,6 +8,7 @@
 #define SRC_DATALOADER_H
 
 #include "utils/config.h"
+#include "datasets/pose_store.h"
 
 class DataLoader {
 public:
@@ -18,7 +19,7 @@ public:
     };
     std::vector<Item> items;
     typedef std::shared_ptr<DataLoader> Ptr;
-    std::map<int, std::map<int, Eigen::Matrix4d>> lidar_poses; // seq, frame_id, pose
+    std::map<int, PoseStore> lidar_poses; // seq, poses indexed by frame_id
 public:
     DataLoader() {
         std::string test_file = g3reg::config.project_path + "/" + g3reg::config.test_file;
@@ -70,7 +71,15 @@ public:
 
     virtual pcl::PointCloud<pcl::PointXYZ>::Ptr GetCloud(std::string dataset_root, int seq, int i) = 0;
 
-    virtual Eigen::Matrix4d getLidarPose(std::string dataset_root, int seq, int frame_id) = 0;
+    // frames without a pose in the pose file get the identity
+    virtual Eigen::Matrix4d getLidarPose(std::string dataset_root, int seq, int frame_id) {
+        auto it = lidar_poses.find(seq);
+        if (it == lidar_poses.end()) {
+            LoadLiDARPoses(dataset_root, seq);
+            it = lidar_poses.find(seq);
+        }
+        return it->second.has(frame_id) ? it->second.at(frame_id) : Eigen::Matrix4d::Identity();
+    }
 
     virtual void LoadLiDARPoses(std::string dataset_root, int seq = -1) = 0;
 };
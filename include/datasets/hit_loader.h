@@ -12,6 +12,7 @@
 #include <pcl/point_cloud.h>
 #include <boost/format.hpp>
 #include "dataloader.h"
+#include "pcd_reader.h"
 #include <robot_utils/lie_utils.h>
 
 class HITLoader : public DataLoader {
@@ -21,45 +22,34 @@ public:
         LOG(INFO) << "Load HIT_MULTI Dataset.";
     }
 
+    std::string GetScanPath(std::string dataset_root, int seq, int i) {
+        return boost::str(boost::format("%s/%02d/pcd/%d.pcd") % dataset_root % seq % i);
+    }
+
     pcl::PointCloud<pcl::PointXYZ>::Ptr GetCloud(std::string dataset_root, int seq, int i) {
-        std::string file_name = boost::str(boost::format("%s/%02d/pcd/%d.pcd") % dataset_root % seq % i);
-        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
-        if (pcl::io::loadPCDFile<pcl::PointXYZ>(file_name, *cloud) == -1) {
-            LOG(ERROR) << "Couldn't read file " << file_name;
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = g3reg::ReadPCDXYZ(GetScanPath(dataset_root, seq, i));
+        if (cloud == nullptr) {
+            cloud.reset(new pcl::PointCloud<pcl::PointXYZ>);
         }
         return cloud;
     }
 
     void LoadLiDARPoses(std::string dataset_root, int seq) {
         std::string pose_file = boost::str(boost::format("%s/%02d/poses.txt") % dataset_root % seq);
-        std::ifstream file(pose_file);
-        if (!file.is_open()) {
+        // x y z qx qy qz qw, the frame id is the line number
+        PoseStore::LineParser parser = [](const char *line, int line_idx, int &frame_id, Eigen::Matrix4d &tf) {
+            double v[7];
+            if (PoseStore::ParseNumbers(line, v, 7) < 7) {
+                return false;
+            }
+            frame_id = line_idx;
+            tf.block<3, 3>(0, 0) = Eigen::Quaterniond(v[6], v[3], v[4], v[5]).toRotationMatrix();
+            tf.block<3, 1>(0, 3) = Eigen::Vector3d(v[0], v[1], v[2]);
+            return true;
+        };
+        if (!lidar_poses[seq].load(pose_file, parser, g3reg::config.pose_cache)) {
             throw std::runtime_error("Could not open file " + pose_file);
         }
-        std::string line;
-        int idx = 0;
-        double x, y, z, qx, qy, qz, qw;
-        lidar_poses[seq] = std::map<int, Eigen::Matrix4d>();
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            iss >> x, iss >> y, iss >> z, iss >> qx, iss >> qy, iss >> qz, iss >> qw;
-            Eigen::Matrix4d tf = Eigen::Matrix4d::Identity();
-            tf.block<3, 3>(0, 0) = Eigen::Quaterniond(qw, qx, qy, qz).toRotationMatrix();
-            tf.block<3, 1>(0, 3) = Eigen::Vector3d(x, y, z);
-            lidar_poses[seq][idx] = tf;
-            idx++;
-        }
-    }
-
-    Eigen::Matrix4d getLidarPose(std::string dataset_root, int seq, int frame_id) {
-        if (lidar_poses.find(seq) == lidar_poses.end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else if (lidar_poses[seq].find(frame_id) == lidar_poses[seq].end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else {
-            return lidar_poses[seq][frame_id];
-        }
-        return lidar_poses[seq][frame_id];
     }
 };
 
@@ -12,6 +12,7 @@
 #include <pcl/point_cloud.h>
 #include <boost/format.hpp>
 #include "dataloader.h"
+#include "bin_reader.h"
 #include <robot_utils/lie_utils.h>
 
 class KITTI360Loader : public DataLoader {
@@ -25,13 +26,14 @@ public:
     }
 
     Eigen::Matrix4d getEgoMotion(int seq, int frame_id) {
-        Eigen::Matrix4d tf = getLidarPose(g3reg::config.dataset_root, seq, frame_id);
-        if (lidar_poses[seq].find(frame_id) != lidar_poses[seq].end() &&
-            lidar_poses[seq].find(frame_id - 1) != lidar_poses[seq].end()) {
-            return lidar_poses[seq][frame_id].inverse() * lidar_poses[seq][frame_id - 1];
-        } else if (lidar_poses[seq].find(frame_id) != lidar_poses[seq].end() &&
-                   lidar_poses[seq].find(frame_id + 1) != lidar_poses[seq].end()) {
-            return lidar_poses[seq][frame_id + 1].inverse() * lidar_poses[seq][frame_id];
+        if (lidar_poses.find(seq) == lidar_poses.end()) {
+            LoadLiDARPoses(g3reg::config.dataset_root, seq);
+        }
+        const PoseStore &poses = lidar_poses[seq];
+        if (poses.has(frame_id) && poses.has(frame_id - 1)) {
+            return poses.at(frame_id).inverse() * poses.at(frame_id - 1);
+        } else if (poses.has(frame_id) && poses.has(frame_id + 1)) {
+            return poses.at(frame_id + 1).inverse() * poses.at(frame_id);
         } else {
             return Eigen::Matrix4d::Identity();
         }
@@ -61,18 +63,81 @@ public:
         }
     }
 
+    /**
+     * Same motion model as deskew, with the motion of every azimuth fraction s taken from a table of num_bins + 1
+     * samples and a polynomial atan2, all in float.
+     * @return bound on the displacement of any point from the exact deskew, in meters
+     */
+    double deskewFast(pcl::PointCloud<pcl::PointXYZ>::Ptr cloud, Eigen::Vector3d rho, Eigen::Vector3d t,
+                      int num_bins) {
+        // rows of R(s) followed by t(s) for s = -0.5 + k / num_bins
+        std::vector<float> table((num_bins + 1) * 12);
+        for (int k = 0; k <= num_bins; k++) {
+            double s = -0.5 + double(k) / num_bins;
+            Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+            if (std::abs(s) * rho.norm() > 1e-10) {
+                R = Eigen::AngleAxisd(s * rho.norm(), rho.normalized()).toRotationMatrix();
+            }
+            float *entry = &table[k * 12];
+            for (int r = 0; r < 3; r++) {
+                entry[r * 3] = R(r, 0), entry[r * 3 + 1] = R(r, 1), entry[r * 3 + 2] = R(r, 2);
+                entry[9 + r] = s * t[r];
+            }
+        }
+        const float scale = num_bins / (2 * M_PI);
+        const float *motion = table.data();
+        pcl::PointXYZ *points = cloud->points.data();
+        int num_points = cloud->size();
+        float max_range_sq = 0;
+#pragma omp parallel for reduction(max:max_range_sq)
+        for (int i = 0; i < num_points; ++i) {
+            float vx = points[i].x, vy = points[i].y, vz = points[i].z;
+            // atan2 with a maximum error of 1.2e-5 rad, branch-free so that the loop vectorizes
+            float ax = std::abs(vx), ay = std::abs(vy);
+            float a = std::min(ax, ay) / std::max(std::max(ax, ay), 1e-30f);
+            float a2 = a * a;
+            float angle = a * (0.9998660f + a2 * (-0.3302995f + a2 * (0.1801410f +
+                                                                         a2 * (-0.0851330f + a2 * 0.0208351f))));
+            angle = ay > ax ? float(M_PI_2) - angle : angle;
+            angle = vx < 0 ? float(M_PI) - angle : angle;
+            angle = vy < 0 ? -angle : angle;
+            int k = std::max(0, std::min(int((angle + float(M_PI)) * scale + 0.5f), num_bins));
+            const float *m = motion + k * 12;
+            points[i].x = m[0] * vx + m[1] * vy + m[2] * vz + m[9];
+            points[i].y = m[3] * vx + m[4] * vy + m[5] * vz + m[10];
+            points[i].z = m[6] * vx + m[7] * vy + m[8] * vz + m[11];
+            max_range_sq = std::max(max_range_sq, vx * vx + vy * vy + vz * vz);
+        }
+        // s is off by at most half a bin plus the atan2 error, which moves a point by |ds| * (|rho| * range + |t|),
+        // float rounding of the transform adds a few ulp of the range
+        double ds = 0.5 / num_bins + 1.2e-5 / (2 * M_PI);
+        double range = std::sqrt(max_range_sq);
+        return ds * (rho.norm() * range + t.norm()) + 1e-6 * range;
+    }
+
+    std::string GetScanPath(std::string dataset_root, int seq, int i) {
+        return boost::str(boost::format("%s/data_3d_raw/2013_05_28_drive_%04d_sync/velodyne_points/data/%010d.bin") %
+                          dataset_root % seq % i);
+    }
+
     pcl::PointCloud<pcl::PointXYZ>::Ptr GetCloud(std::string dataset_root, int seq, int i) {
-        std::string file_name = boost::str(
-                boost::format("%s/data_3d_raw/2013_05_28_drive_%04d_sync/velodyne_points/data/%010d.bin") %
-                dataset_root % seq % i);
+        std::string file_name = GetScanPath(dataset_root, seq, i);
         robot_utils::TicToc t;
-        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = kitti_utils::ReadCloudXYZ(file_name);
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = g3reg::config.crop_on_load ?
+                g3reg::ReadBinXYZ(file_name, g3reg::config.min_range, g3reg::config.max_range) :
+                g3reg::ReadBinXYZ(file_name);
         Eigen::Matrix4d ego_motion = getEgoMotion(seq, i);
         if ((ego_motion - Eigen::Matrix4d::Identity()).norm() > 0.1) {
             Eigen::Matrix3d R = ego_motion.block<3, 3>(0, 0);
             Eigen::Vector3d rho = robot_utils::R2so3(R);
             Eigen::Vector3d t = ego_motion.block<3, 1>(0, 3);
-            deskew(cloud, rho, t);
+            if (g3reg::config.deskew_mode == "fast") {
+                double error_bound = deskewFast(cloud, rho, t, g3reg::config.deskew_bins);
+                LOG_FIRST_N(INFO, 1) << "Fast deskew with " << g3reg::config.deskew_bins
+                                     << " bins, error bound of the first scan: " << error_bound << " m";
+            } else {
+                deskew(cloud, rho, t);
+            }
         }
         return cloud;
     }
@@ -80,34 +145,20 @@ public:
     void LoadLiDARPoses(std::string dataset_root, int seq) {
         std::string pose_file = boost::str(
                 boost::format("%s/data_poses/2013_05_28_drive_%04d_sync/poses.txt") % dataset_root % seq);
-        std::ifstream file(pose_file);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open file " + pose_file);
-        }
-        std::string line;
-        int idx;
-        lidar_poses[seq] = std::map<int, Eigen::Matrix4d>();
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            iss >> idx;
-            Eigen::Matrix4d tf = Eigen::Matrix4d::Identity();
-            for (int i = 0; i < 3; i++) {
-                iss >> tf(i, 0) >> tf(i, 1) >> tf(i, 2) >> tf(i, 3);
+        // frame id followed by a 3x4 pose, only some frames have one
+        PoseStore::LineParser parser = [](const char *line, int line_idx, int &frame_id, Eigen::Matrix4d &tf) {
+            double v[13];
+            if (PoseStore::ParseNumbers(line, v, 13) < 13) {
+                return false;
             }
-            tf = tf * calib_lidar_to_pose;
-            lidar_poses[seq][idx] = tf;
-        }
-    }
-
-    Eigen::Matrix4d getLidarPose(std::string dataset_root, int seq, int frame_id) {
-        if (lidar_poses.find(seq) == lidar_poses.end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else if (lidar_poses[seq].find(frame_id) == lidar_poses[seq].end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else {
-            return lidar_poses[seq][frame_id];
+            frame_id = v[0];
+            tf.topRows<3>() = Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>>(v + 1);
+            return true;
+        };
+        if (!lidar_poses[seq].load(pose_file, parser, g3reg::config.pose_cache)) {
+            throw std::runtime_error("Could not open file " + pose_file);
         }
-        return lidar_poses[seq][frame_id];
+        lidar_poses[seq].transform(calib_lidar_to_pose);
     }
 
     Eigen::Matrix4d getLidarToIMU(std::string dataset_root) {
@@ -15,6 +15,7 @@
 #include "utils/config.h"
 #include "dataset/kitti_utils.h"
 #include "datasets/dataloader.h"
+#include "datasets/bin_reader.h"
 
 class KittiLoader : public DataLoader {
 
@@ -23,46 +24,31 @@ public:
         LOG(INFO) << "Load Kitti Dataset.";
     }
 
-    Eigen::Matrix4d getLidarPose(std::string dataset_root, int seq, int frame_id) {
-        if (lidar_poses.find(seq) == lidar_poses.end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else if (lidar_poses[seq].find(frame_id) == lidar_poses[seq].end()) {
-            LoadLiDARPoses(dataset_root, seq);
-        } else {
-            return lidar_poses[seq][frame_id];
-        }
-        return lidar_poses[seq][frame_id];
-    }
-
     pcl::PointCloud<pcl::PointXYZ>::Ptr GetCloud(std::string dataset_root, int seq, int i) {
-        return kitti_utils::GetCloud(dataset_root, seq, i);
+        std::string file_name = kitti_utils::GetPCDPath(dataset_root, seq, i);
+        if (g3reg::config.crop_on_load) {
+            return g3reg::ReadBinXYZ(file_name, g3reg::config.min_range, g3reg::config.max_range);
+        }
+        return g3reg::ReadBinXYZ(file_name);
     }
 
     void LoadLiDARPoses(std::string dataset_root, int seq) {
         std::string pose_file = (boost::format("%s/%02d/poses.txt") % g3reg::config.dataset_root % seq).str();
-        //    read kitti pose txt
-        std::fstream f;
-        f.open(pose_file, std::ios::in);
-        if (!f.is_open()) {
+        // 3x4 camera poses, the frame id is the line number
+        PoseStore::LineParser parser = [](const char *line, int line_idx, int &frame_id, Eigen::Matrix4d &Twc) {
+            double v[12];
+            if (PoseStore::ParseNumbers(line, v, 12) < 12) {
+                return false;
+            }
+            frame_id = line_idx;
+            Twc.topRows<3>() = Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>>(v);
+            return true;
+        };
+        if (!lidar_poses[seq].load(pose_file, parser, g3reg::config.pose_cache)) {
             LOG(FATAL) << "Cannot open pose file: " << pose_file;
         }
         Eigen::Matrix4d Tr = GetTr(g3reg::config.dataset_root, seq); // lidar to camera
-        std::string line;
-        int num = -1;
-        lidar_poses[seq] = std::map<int, Eigen::Matrix4d>();
-        while (std::getline(f, line)) {
-            num++;
-            std::stringstream ss(line);
-            Eigen::Matrix4d Twc = Eigen::Matrix4d::Identity();
-            for (int i = 0; i < 3; ++i) {
-                for (int j = 0; j < 4; ++j) {
-                    ss >> Twc(i, j);
-                }
-            }
-            Eigen::Matrix4d Twl = Twc * Tr;
-            lidar_poses[seq][num] = Twl;
-        }
-        f.close();
+        lidar_poses[seq].transform(Tr);
     }
 
     Eigen::Matrix4d GetTr(std::string dataset_root, int seq) {
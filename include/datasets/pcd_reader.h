@@ -0,0 +1,199 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_PCD_READER_H
+#define SRC_PCD_READER_H
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <sstream>
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <glog/logging.h>
+#include "utils/mapped_file.h"
+
+namespace g3reg {
+
+    // LZF decompression as used by binary_compressed PCD files, returns the decompressed size or 0 on corrupt input
+    inline size_t LzfDecompress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+        const uint8_t *ip = in, *in_end = in + in_len;
+        uint8_t *op = out, *out_end = out + out_len;
+        while (ip < in_end) {
+            size_t ctrl = *ip++;
+            if (ctrl < 32) {
+                // literal run of ctrl + 1 bytes
+                ctrl++;
+                if (op + ctrl > out_end || ip + ctrl > in_end) {
+                    return 0;
+                }
+                std::memcpy(op, ip, ctrl);
+                op += ctrl;
+                ip += ctrl;
+            } else {
+                // back reference, the source may overlap the destination
+                size_t len = ctrl >> 5;
+                if (ip >= in_end) {
+                    return 0;
+                }
+                if (len == 7) {
+                    len += *ip++;
+                    if (ip >= in_end) {
+                        return 0;
+                    }
+                }
+                size_t distance = ((ctrl & 0x1f) << 8) + 1 + *ip++;
+                len += 2;
+                if (op + len > out_end || distance > size_t(op - out)) {
+                    return 0;
+                }
+                const uint8_t *ref = op - distance;
+                for (size_t i = 0; i < len; i++) {
+                    op[i] = ref[i];
+                }
+                op += len;
+            }
+        }
+        return op - out;
+    }
+
+    /**
+     * Read only x, y, z of a binary or binary_compressed PCD file whose coordinates are float32.
+     * Other layouts (ascii, double coordinates) go through pcl::io::loadPCDFile.
+     * @return nullptr if the file cannot be read
+     */
+    inline pcl::PointCloud<pcl::PointXYZ>::Ptr ReadPCDXYZ(const std::string &pcd_path) {
+        auto load_pcl = [&pcd_path]() {
+            pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+            if (pcl::io::loadPCDFile<pcl::PointXYZ>(pcd_path, *cloud) == -1) {
+                LOG(ERROR) << "Couldn't read file " << pcd_path;
+                return pcl::PointCloud<pcl::PointXYZ>::Ptr();
+            }
+            return cloud;
+        };
+        MappedFile file;
+        if (!file.open(pcd_path)) {
+            LOG(ERROR) << "Couldn't read file " << pcd_path;
+            return nullptr;
+        }
+
+        // header lines up to and including DATA
+        std::vector<std::string> fields;
+        std::vector<int> sizes, counts;
+        std::vector<char> types;
+        size_t width = 0, height = 1, num_points = 0, pos = 0;
+        std::string data_type;
+        while (pos < file.size() && data_type.empty()) {
+            const void *line_end = std::memchr(file.data() + pos, '\n', file.size() - pos);
+            size_t end = line_end == nullptr ? file.size() : static_cast<const char *>(line_end) - file.data();
+            std::istringstream line(std::string(file.data() + pos, end - pos));
+            pos = end + 1;
+            std::string key;
+            line >> key;
+            if (key == "FIELDS") {
+                for (std::string v; line >> v;) fields.push_back(v);
+            } else if (key == "SIZE") {
+                for (int v; line >> v;) sizes.push_back(v);
+            } else if (key == "TYPE") {
+                for (char v; line >> v;) types.push_back(v);
+            } else if (key == "COUNT") {
+                for (int v; line >> v;) counts.push_back(v);
+            } else if (key == "WIDTH") {
+                line >> width;
+            } else if (key == "HEIGHT") {
+                line >> height;
+            } else if (key == "POINTS") {
+                line >> num_points;
+            } else if (key == "DATA") {
+                line >> data_type;
+            }
+        }
+        if (counts.empty()) {
+            counts.assign(fields.size(), 1);
+        }
+        if (num_points == 0) {
+            num_points = width * height;
+        }
+        if (sizes.size() != fields.size() || types.size() != fields.size() || counts.size() != fields.size() ||
+            (data_type != "binary" && data_type != "binary_compressed")) {
+            return load_pcl();
+        }
+
+        // byte offset of every field inside a point record
+        int xyz_offset[3] = {-1, -1, -1}, xyz_field[3] = {-1, -1, -1};
+        size_t point_step = 0;
+        std::vector<size_t> field_offsets;
+        for (size_t f = 0; f < fields.size(); f++) {
+            field_offsets.push_back(point_step);
+            for (int c = 0; c < 3; c++) {
+                if (fields[f] == std::string(1, "xyz"[c]) && sizes[f] == 4 && types[f] == 'F' && counts[f] == 1) {
+                    xyz_offset[c] = point_step;
+                    xyz_field[c] = f;
+                }
+            }
+            point_step += sizes[f] * counts[f];
+        }
+        if (xyz_field[0] < 0 || xyz_field[1] < 0 || xyz_field[2] < 0) {
+            return load_pcl();
+        }
+
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+        cloud->resize(num_points);
+        pcl::PointXYZ *points = cloud->points.data();
+        if (data_type == "binary") {
+            if (pos + num_points * point_step > file.size()) {
+                LOG(ERROR) << "Truncated pcd file " << pcd_path;
+                return nullptr;
+            }
+            const char *data = file.data() + pos;
+            for (size_t i = 0; i < num_points; i++) {
+                const char *record = data + i * point_step;
+                std::memcpy(&points[i].x, record + xyz_offset[0], sizeof(float));
+                std::memcpy(&points[i].y, record + xyz_offset[1], sizeof(float));
+                std::memcpy(&points[i].z, record + xyz_offset[2], sizeof(float));
+            }
+        } else {
+            uint32_t compressed_size, uncompressed_size;
+            if (pos + 8 > file.size()) {
+                return nullptr;
+            }
+            std::memcpy(&compressed_size, file.data() + pos, 4);
+            std::memcpy(&uncompressed_size, file.data() + pos + 4, 4);
+            if (pos + 8 + compressed_size > file.size() || uncompressed_size < num_points * point_step) {
+                LOG(ERROR) << "Truncated pcd file " << pcd_path;
+                return nullptr;
+            }
+            std::vector<uint8_t> buffer(uncompressed_size);
+            if (LzfDecompress(reinterpret_cast<const uint8_t *>(file.data() + pos + 8), compressed_size,
+                              buffer.data(), buffer.size()) != uncompressed_size) {
+                LOG(ERROR) << "Corrupt compressed pcd file " << pcd_path;
+                return nullptr;
+            }
+            // the decompressed data stores every field for all points before the next field
+            for (int c = 0; c < 3; c++) {
+                const uint8_t *column = buffer.data() + field_offsets[xyz_field[c]] * num_points;
+                for (size_t i = 0; i < num_points; i++) {
+                    std::memcpy(points[i].data + c, column + i * sizeof(float), sizeof(float));
+                }
+            }
+        }
+        if (width * height != num_points) {
+            width = num_points;
+            height = 1;
+        }
+        cloud->width = width;
+        cloud->height = height;
+        cloud->is_dense = std::all_of(cloud->points.begin(), cloud->points.end(), [](const pcl::PointXYZ &p) {
+            return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+        });
+        return cloud;
+    }
+}
+
+#endif //SRC_PCD_READER_H
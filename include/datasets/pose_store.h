@@ -0,0 +1,232 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_POSE_STORE_H
+#define SRC_POSE_STORE_H
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <sys/stat.h>
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <glog/logging.h>
+
+// poses of one sequence in a dense vector indexed by frame id
+class PoseStore {
+public:
+    // fills the frame id and pose of one text line, returns false for lines without a pose
+    typedef std::function<bool(const char *line, int line_idx, int &frame_id, Eigen::Matrix4d &pose)> LineParser;
+
+    bool has(int frame_id) const {
+        return frame_id >= 0 && frame_id < int(valid_.size()) && valid_[frame_id];
+    }
+
+    const Eigen::Matrix4d &at(int frame_id) const {
+        return poses_[frame_id];
+    }
+
+    void set(int frame_id, const Eigen::Matrix4d &pose) {
+        if (frame_id >= int(poses_.size())) {
+            poses_.resize(frame_id + 1, Eigen::Matrix4d::Identity());
+            valid_.resize(frame_id + 1, 0);
+        }
+        poses_[frame_id] = pose;
+        valid_[frame_id] = 1;
+    }
+
+    // right-multiply every pose, e.g. by the lidar extrinsics
+    void transform(const Eigen::Matrix4d &tf) {
+        for (size_t i = 0; i < poses_.size(); i++) {
+            if (valid_[i]) {
+                poses_[i] = poses_[i] * tf;
+            }
+        }
+    }
+
+    size_t size() const {
+        return poses_.size();
+    }
+
+    /**
+     * Load the poses of a text file, through the binary cache text_path + ".cache" when it matches the size and
+     * modification time of the text file. Otherwise the text is parsed in parallel and the cache is rewritten.
+     * @return false if the text file does not exist
+     */
+    bool load(const std::string &text_path, const LineParser &parser, bool use_cache = true) {
+        struct stat st;
+        if (stat(text_path.c_str(), &st) != 0) {
+            return false;
+        }
+        cache_path_ = text_path + ".cache";
+        if (use_cache && loadCache(cache_path_, st.st_size, st.st_mtime)) {
+            return true;
+        }
+        if (!parseText(text_path, parser)) {
+            return false;
+        }
+        if (use_cache && !saveCache(cache_path_, st.st_size, st.st_mtime)) {
+            LOG(WARNING) << "Cannot write pose cache " << cache_path_;
+        }
+        return true;
+    }
+
+    // delete the binary cache of the last loaded text file, so that the next load parses the text again
+    bool removeCache() const {
+        return !cache_path_.empty() && (std::remove(cache_path_.c_str()) == 0 || errno == ENOENT);
+    }
+
+    bool parseText(const std::string &text_path, const LineParser &parser) {
+        std::ifstream file(text_path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        // terminate every line in place so that each one is parsed independently
+        std::vector<size_t> line_starts;
+        size_t start = 0;
+        for (size_t i = 0; i < buffer.size(); i++) {
+            if (buffer[i] == '\n') {
+                buffer[i] = '\0';
+                line_starts.push_back(start);
+                start = i + 1;
+            }
+        }
+        if (start < buffer.size()) {
+            line_starts.push_back(start);
+        }
+        int num_lines = line_starts.size();
+        std::vector<int> frame_ids(num_lines, -1);
+        std::vector<Eigen::Matrix4d, Eigen::aligned_allocator<Eigen::Matrix4d>> poses(num_lines);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < num_lines; i++) {
+            Eigen::Matrix4d pose = Eigen::Matrix4d::Identity();
+            int frame_id;
+            if (parser(buffer.c_str() + line_starts[i], i, frame_id, pose)) {
+                frame_ids[i] = frame_id;
+                poses[i] = pose;
+            }
+        }
+        poses_.clear();
+        valid_.clear();
+        for (int i = 0; i < num_lines; i++) {
+            if (frame_ids[i] >= 0) {
+                set(frame_ids[i], poses[i]);
+            }
+        }
+        return true;
+    }
+
+    // parse up to n numbers of a line, returns how many were found
+    static int ParseNumbers(const char *line, double *values, int n) {
+        char *end;
+        int count = 0;
+        for (; count < n; count++) {
+            values[count] = std::strtod(line, &end);
+            if (end == line) {
+                break;
+            }
+            line = end;
+        }
+        return count;
+    }
+
+private:
+    // header: magic, size and mtime of the text file, number of frames, then (frame id, 3x4 row-major pose) entries
+    struct CacheHeader {
+        char magic[8];
+        int64_t text_size, text_mtime;
+        int64_t num_frames, num_poses;
+    };
+
+    bool loadCache(const std::string &cache_path, int64_t text_size, int64_t text_mtime) {
+        FILE *file = fopen(cache_path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        CacheHeader header;
+        struct stat st;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "G3RPOSE1", 8) == 0 &&
+                  header.text_size == text_size && header.text_mtime == text_mtime && fstat(fileno(file), &st) == 0;
+        // the counts of a corrupt cache must not size the buffers: the entries have to fill the rest of the file
+        // exactly, and the frames end at the largest frame id of the entries, as saveCache writes them
+        const int64_t entry_bytes = ok ? st.st_size - int64_t(sizeof(header)) : 0;
+        ok = ok && entry_bytes % int64_t(kEntrySize) == 0 && header.num_poses == entry_bytes / int64_t(kEntrySize);
+        std::vector<char> entries;
+        if (ok) {
+            entries.resize(entry_bytes);
+            ok = fread(entries.data(), kEntrySize, header.num_poses, file) == size_t(header.num_poses);
+        }
+        fclose(file);
+        int64_t num_frames = 0;
+        for (int64_t i = 0; i < header.num_poses && ok; i++) {
+            int32_t frame_id;
+            std::memcpy(&frame_id, entries.data() + i * kEntrySize, sizeof(frame_id));
+            ok = frame_id >= 0;
+            num_frames = std::max(num_frames, int64_t(frame_id) + 1);
+        }
+        if (!ok || num_frames != header.num_frames) {
+            return false;
+        }
+        poses_.assign(num_frames, Eigen::Matrix4d::Identity());
+        valid_.assign(num_frames, 0);
+        for (int64_t i = 0; i < header.num_poses; i++) {
+            int32_t frame_id;
+            double values[12];
+            std::memcpy(&frame_id, entries.data() + i * kEntrySize, sizeof(frame_id));
+            std::memcpy(values, entries.data() + i * kEntrySize + sizeof(frame_id), sizeof(values));
+            poses_[frame_id].topRows<3>() = Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>>(values);
+            valid_[frame_id] = 1;
+        }
+        return true;
+    }
+
+    bool saveCache(const std::string &cache_path, int64_t text_size, int64_t text_mtime) const {
+        std::string tmp_path = cache_path + ".tmp";
+        FILE *file = fopen(tmp_path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        CacheHeader header;
+        std::memcpy(header.magic, "G3RPOSE1", 8);
+        header.text_size = text_size;
+        header.text_mtime = text_mtime;
+        header.num_frames = poses_.size();
+        header.num_poses = 0;
+        std::vector<char> entries;
+        for (size_t i = 0; i < poses_.size(); i++) {
+            if (!valid_[i]) {
+                continue;
+            }
+            int32_t frame_id = i;
+            Eigen::Matrix<double, 3, 4, Eigen::RowMajor> top = poses_[i].topRows<3>();
+            size_t offset = entries.size();
+            entries.resize(offset + kEntrySize);
+            std::memcpy(entries.data() + offset, &frame_id, sizeof(frame_id));
+            std::memcpy(entries.data() + offset + sizeof(frame_id), top.data(), 12 * sizeof(double));
+            header.num_poses++;
+        }
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(entries.data(), 1, entries.size(), file) == entries.size();
+        ok = fclose(file) == 0 && ok;
+        return ok && std::rename(tmp_path.c_str(), cache_path.c_str()) == 0;
+    }
+
+    static constexpr size_t kEntrySize = sizeof(int32_t) + 12 * sizeof(double);
+
+    std::vector<Eigen::Matrix4d, Eigen::aligned_allocator<Eigen::Matrix4d>> poses_;
+    std::vector<char> valid_;
+    std::string cache_path_;
+};
+
+#endif //SRC_POSE_STORE_H
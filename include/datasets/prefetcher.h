@@ -0,0 +1,173 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_PREFETCHER_H
+#define SRC_PREFETCHER_H
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <exception>
+#include <condition_variable>
+#include <omp.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/filters/voxel_grid.h>
+#include "datasets/dataloader.h"
+
+/**
+ * Loads the clouds of the next test items on background threads while the current pair is registered.
+ * Pairs are handed out in item order. At most queue_depth pairs are loaded ahead, and loading pauses while the
+ * queued clouds exceed memory_mb (the pair needed next is always loaded).
+ * GetCloud of the loaders caches poses without locking, so the workers call it one at a time and only the optional
+ * voxelization runs concurrently. The workers run their OpenMP regions (e.g. deskewing) on one thread, so that they
+ * do not compete for the cores with the registration being timed.
+ */
+class PairPrefetcher {
+public:
+    struct Params {
+        int queue_depth = 0;        // pairs loaded ahead, 0 loads every pair synchronously in next()
+        int num_threads = 1;
+        double memory_mb = 2048;    // cap on the clouds waiting in the queue
+        double voxel_size = 0;      // voxelize the clouds after loading, 0 keeps them as read
+    };
+
+    struct Pair {
+        DataLoader::Item item;
+        pcl::PointCloud<pcl::PointXYZ>::Ptr src_cloud, tgt_cloud;
+    };
+
+    PairPrefetcher(DataLoader::Ptr loader, const Params &params) : loader_(loader), params_(params) {
+        for (int i = 0; params_.queue_depth > 0 && i < std::max(1, params_.num_threads); i++) {
+            workers_.emplace_back(&PairPrefetcher::work, this);
+        }
+    }
+
+    ~PairPrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &worker: workers_) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Wait for the next pair in item order.
+     * @param stall_ms time spent waiting for the pair, i.e. I/O not hidden behind the previous registration
+     * @return false once all items are consumed
+     */
+    bool next(Pair &pair, double &stall_ms) {
+        auto start = std::chrono::steady_clock::now();
+        if (next_consume_ >= loader_->items.size()) {
+            return false;
+        }
+        if (params_.queue_depth <= 0) {
+            pair = load(next_consume_++);
+            stall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return ready_.count(next_consume_) > 0; });
+        Slot slot = std::move(ready_[next_consume_]);
+        ready_.erase(next_consume_);
+        queued_bytes_ -= slot.bytes;
+        next_consume_++;
+        lock.unlock();
+        cv_.notify_all();
+        stall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (slot.error) {
+            std::rethrow_exception(slot.error);
+        }
+        pair = std::move(slot.pair);
+        return true;
+    }
+
+private:
+    struct Slot {
+        Pair pair;
+        size_t bytes = 0;
+        std::exception_ptr error;
+    };
+
+    Pair load(size_t idx) {
+        Pair pair;
+        pair.item = loader_->items[idx];
+        {
+            std::lock_guard<std::mutex> lock(load_mutex_);
+            pair.src_cloud = loader_->GetCloud(g3reg::config.dataset_root, pair.item.seq, pair.item.src_idx);
+            pair.tgt_cloud = loader_->GetCloud(g3reg::config.dataset_root, pair.item.seq_db, pair.item.tgt_idx);
+        }
+        if (params_.voxel_size > 0) {
+            pair.src_cloud = voxelize(pair.src_cloud);
+            pair.tgt_cloud = voxelize(pair.tgt_cloud);
+        }
+        return pair;
+    }
+
+    pcl::PointCloud<pcl::PointXYZ>::Ptr voxelize(const pcl::PointCloud<pcl::PointXYZ>::Ptr &cloud) {
+        if (cloud == nullptr) {
+            return cloud;
+        }
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_ds(new pcl::PointCloud<pcl::PointXYZ>);
+        pcl::VoxelGrid<pcl::PointXYZ> voxel_filter;
+        voxel_filter.setInputCloud(cloud);
+        voxel_filter.setLeafSize(params_.voxel_size, params_.voxel_size, params_.voxel_size);
+        voxel_filter.filter(*cloud_ds);
+        return cloud_ds;
+    }
+
+    void work() {
+        omp_set_num_threads(1);
+        const size_t num_items = loader_->items.size();
+        const double max_bytes = params_.memory_mb * 1024 * 1024;
+        while (true) {
+            size_t idx;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] {
+                    return stop_ || next_claim_ >= num_items ||
+                           (next_claim_ < next_consume_ + params_.queue_depth &&
+                            (queued_bytes_ < max_bytes || next_claim_ == next_consume_));
+                });
+                if (stop_ || next_claim_ >= num_items) {
+                    return;
+                }
+                idx = next_claim_++;
+            }
+            Slot slot;
+            try {
+                slot.pair = load(idx);
+                for (const auto &cloud: {slot.pair.src_cloud, slot.pair.tgt_cloud}) {
+                    slot.bytes += cloud == nullptr ? 0 : cloud->size() * sizeof(pcl::PointXYZ);
+                }
+            } catch (...) {
+                slot.error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queued_bytes_ += slot.bytes;
+                ready_[idx] = std::move(slot);
+            }
+            cv_.notify_all();
+        }
+    }
+
+    DataLoader::Ptr loader_;
+    Params params_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_, load_mutex_;
+    std::condition_variable cv_;
+    std::map<size_t, Slot> ready_;
+    size_t next_claim_ = 0, next_consume_ = 0;
+    double queued_bytes_ = 0;
+    bool stop_ = false;
+};
+
+#endif //SRC_PREFETCHER_H
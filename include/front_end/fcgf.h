@@ -8,8 +8,52 @@
 #define SRC_FCGF_H
 
 #include "front_end/gem/ellipsoid.h"
+#include "utils/mapped_file.h"
 
 namespace fcgf {
+
+    /**
+     * N x 6 correspondences (src xyz, tgt xyz). A C-ordered float64/float32 .npy file is mapped and read in place,
+     * a text file is parsed once into memory.
+     */
+    class Correspondences {
+    public:
+        bool load(const std::string &path);
+
+        size_t rows() const {
+            return rows_;
+        }
+
+        Eigen::Vector3d src(size_t i) const {
+            return point(i * 6);
+        }
+
+        Eigen::Vector3d tgt(size_t i) const {
+            return point(i * 6 + 3);
+        }
+
+    private:
+        bool loadNpy(const std::string &path);
+
+        bool loadText(const std::string &path);
+
+        Eigen::Vector3d point(size_t offset) const {
+            if (is_float_) {
+                return Eigen::Map<const Eigen::Vector3f>(reinterpret_cast<const float *>(data_) + offset).cast<double>();
+            }
+            return Eigen::Map<const Eigen::Vector3d>(reinterpret_cast<const double *>(data_) + offset);
+        }
+
+        g3reg::MappedFile file_;
+        std::vector<double> parsed_;
+        const char *data_ = nullptr;
+        bool is_float_ = false;
+        size_t rows_ = 0;
+    };
+
+    // write N x 6 correspondences as a float64 .npy file readable by Correspondences and numpy.load
+    bool WriteNpy(const std::string &path, const double *data, size_t rows);
+
     clique_solver::Association matching(std::tuple<int, int, int> pair_info,
                                         std::vector<clique_solver::GraphVertex::Ptr> &src_nodes,
                                         std::vector<clique_solver::GraphVertex::Ptr> &tgt_nodes);
@@ -61,6 +61,13 @@ namespace clique_solver {
             return Eigen::VectorXd::Zero(1, 1);
         }
 
+        /**
+         * Consistency of the z components of two TIMs, which a rotation about the z axis keeps. Used on top of
+         * consistent() in the yaw-only mode, with the same per-level weights. By default the bound of a level is
+         * twice its noise bound, as for points.
+         */
+        virtual Eigen::VectorXd consistentHeight(const GraphVertex &other);
+
     public:
         Eigen::Vector3d centroid;
         Eigen::Matrix3d covariance;
@@ -100,6 +107,8 @@ namespace clique_solver {
 
         Eigen::VectorXd consistent(const GraphVertex &other) override;
 
+        Eigen::VectorXd consistentHeight(const GraphVertex &other) override;
+
         double upper_rho(const Eigen::Matrix3d &cov);
     };
 
@@ -133,6 +142,8 @@ namespace clique_solver {
         GraphVertex::Ptr operator-(const GraphVertex &other) const override;
 
         Eigen::VectorXd consistent(const GraphVertex &other) override;
+
+        Eigen::VectorXd consistentHeight(const GraphVertex &other) override;
     };
 
     clique_solver::GraphVertex::Ptr create_vertex(const Eigen::Vector3d &center, const VertexInfo &vertex_info,
@@ -38,12 +38,34 @@ namespace g3reg {
 
         // Front Engd
         double max_range, min_range, ds_resolution;
+        bool crop_on_load, pose_cache;
+        // read and write FCGF correspondences as <name>.npy next to <name>.txt, a .npy older than its .txt is stale
+        bool corr_cache;
+        std::string deskew_mode;
+        int deskew_bins;
+        // benchmark prefetching
+        int prefetch_pairs, prefetch_threads;
+        double prefetch_memory_mb, prefetch_voxel_size;
+        // per-stage span tracing, dumped by the benchmarks
+        bool trace_stages;
+        // per-stage allocations and peak memory in FRGresult::memory
+        bool memory_stages;
         int min_cluster_size;
         // Association
         std::string assoc_method;
         int assoc_topk, num_clusters, num_planes, num_lines, max_corrs;
         // GEM
         bool use_pseudo_cov, plane_aided, use_bbox_center, grad_pmc;
+        // max clique of the PAGOR levels, mac_solver: "pmc" (exact), "clipper" (dense clique of each level, started
+        // from the solution of the previous level) or "pyclipper" (one homotopy through all levels)
+        std::string mac_solver;
+        teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE mac_solver_mode;
+        // solve the transforms of all PAGOR levels in one batch, warm-started from overlapping levels
+        bool tf_batch;
+        // 4-DoF registration (x, y, z, yaw) for ground vehicles: the graphs also check the heights of the TIMs,
+        // the transform is solved by TLS yaw and translation whatever tf_solver is, and verification only scores
+        // yaw candidates
+        bool yaw_only;
 
         // Back End
         // PAGOR
@@ -53,6 +75,11 @@ namespace g3reg {
         clique_solver::VertexInfo vertex_info;
         //RANSAC
         double ransac_max_iterations, ransac_inlier_threshold, ransac_inliers_to_end;
+        std::string ransac_scoring;
+        int ransac_preemptive_hypotheses, ransac_preemptive_block;
+        //3DMAC
+        int mac_max_branches, mac_max_cliques;
+        double mac_time_limit;
 
         // Transformation Verification
         std::string verify_mtd, robust_kernel;
@@ -9,6 +9,7 @@
 
 #include "utils/config.h"
 #include "robot_utils/lie_utils.h"
+#include "utils/memory.h"
 
 typedef struct {
     double recall = 0;
@@ -38,8 +39,12 @@ public:
     double feature_time = 0;
     double tf_solver_time = 0;
     double clique_time = 0, graph_time = 0;
+    std::vector<double> level_times; // tf solving of each PAGOR level
+    std::vector<double> clique_level_times; // max clique of each PAGOR level
     double verify_time = 0;
     double total_time = 0;
+    double io_stall_time = 0; // waiting for the clouds of this pair before registration
+    std::vector<g3reg::StageMemory> memory; // filled when config.memory_stages is set
     bool valid = true;
 };
 
@@ -53,12 +58,14 @@ public:
     double graph_time, graph_time_avg;
     double verify_time, verify_time_avg;
     double total_time, total_time_avg;
+    double io_stall_time, io_stall_time_avg;
     double plane_inliers, plane_inliers_avg;
     double line_inliers, line_inliers_avg;
     double cluster_inliers, cluster_inliers_avg;
     double rot_err_mae, rot_err_rmse;
     double trans_err_mae, trans_err_rmse;
-    std::vector<double> rot_errs, trans_errs, feature_times, clique_times, graph_times, verify_times, solver_times, runtimes;
+    std::vector<double> rot_errs, trans_errs, feature_times, clique_times, graph_times, verify_times, solver_times, runtimes, io_stall_times;
+    std::vector<std::vector<g3reg::StageMemory>> memories; // per pair, empty unless config.memory_stages
 
     Evaluation() {
         num = success_num = success_num_upper = success_rate = success_rate_upper = 0;
@@ -68,6 +75,7 @@ public:
         graph_time = graph_time_avg = 0;
         verify_time = verify_time_avg = 0;
         total_time = total_time_avg = 0;
+        io_stall_time = io_stall_time_avg = 0;
         plane_inliers = plane_inliers_avg = 0;
         line_inliers = line_inliers_avg = 0;
         cluster_inliers = cluster_inliers_avg = 0;
@@ -81,6 +89,8 @@ public:
         graph_times.clear();
         verify_times.clear();
         solver_times.clear();
+        io_stall_times.clear();
+        memories.clear();
     }
 
     std::pair<bool, bool> update(FRGresult solution, const Eigen::Matrix4d &tf_gt) {
@@ -91,6 +101,7 @@ public:
         graph_time = solution.graph_time;
         verify_time = solution.verify_time;
         total_time = solution.total_time;
+        io_stall_time = solution.io_stall_time;
         plane_inliers = solution.plane_inliers;
         line_inliers = solution.line_inliers;
         cluster_inliers = solution.cluster_inliers;
@@ -101,6 +112,7 @@ public:
         graph_time_avg = (graph_time_avg * (num - 1) + graph_time) / num;
         verify_time_avg = (verify_time_avg * (num - 1) + verify_time) / num;
         total_time_avg = (total_time_avg * (num - 1) + total_time) / num;
+        io_stall_time_avg = (io_stall_time_avg * (num - 1) + io_stall_time) / num;
         plane_inliers_avg = (plane_inliers_avg * (num - 1) + plane_inliers) / num;
         line_inliers_avg = (line_inliers_avg * (num - 1) + line_inliers) / num;
         cluster_inliers_avg = (cluster_inliers_avg * (num - 1) + cluster_inliers) / num;
@@ -110,6 +122,10 @@ public:
         graph_times.push_back(graph_time);
         verify_times.push_back(verify_time);
         solver_times.push_back(tf_solver_time);
+        io_stall_times.push_back(io_stall_time);
+        if (!solution.memory.empty()) {
+            memories.push_back(solution.memory);
+        }
 
         bool success_flag_upper = false, success_flag = false;
         if (is_succ(solution.tf, tf_gt)) {
@@ -179,6 +195,20 @@ public:
         std::string solver_time_filename =
                 runtime_dir + "/solver_times" + (seq == -1 ? "" : std::to_string(seq)) + ".txt";
         writeStatistics(solver_time_filename, solver_times);
+        std::string io_stall_time_filename =
+                runtime_dir + "/io_stall_times" + (seq == -1 ? "" : std::to_string(seq)) + ".txt";
+        writeStatistics(io_stall_time_filename, io_stall_times);
+        if (!memories.empty()) {
+            std::string memory_filename = runtime_dir + "/memory" + (seq == -1 ? "" : std::to_string(seq)) + ".txt";
+            std::ofstream file(memory_filename);
+            file << "pair stage allocs alloc_mb peak_heap_mb rss_mb peak_rss_mb" << std::endl;
+            for (int i = 0; i < memories.size(); i++) {
+                for (const auto &m: memories[i]) {
+                    file << i << " " << m.stage << " " << m.allocs << " " << m.alloc_mb << " " << m.peak_heap_mb << " "
+                         << m.rss_mb << " " << m.peak_rss_mb << std::endl;
+                }
+            }
+        }
     }
 
     void computePoseErr() {
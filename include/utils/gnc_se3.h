@@ -0,0 +1,304 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_GNC_SE3_H
+#define SRC_GNC_SE3_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/SVD>
+#include <Eigen/LU>
+#include <Eigen/Cholesky>
+
+namespace g3reg {
+
+    // defaults of gtsam::GncParams<LevenbergMarquardtParams> with the TLS loss
+    struct GncTlsParams {
+        int max_iterations = 100;
+        double mu_step = 1.4;
+        double relative_cost_tol = 1e-5;
+        double weights_tol = 1e-4;
+        double barc_sq = 0.5 * 11.344867;   // 0.5 * chi2inv(0.99, 3), the gtsam inlier threshold of a 3d residual
+        // Levenberg-Marquardt of each GNC step
+        int lm_max_iterations = 100;
+        double lm_relative_tol = 1e-5, lm_absolute_tol = 1e-5;
+        double lambda_initial = 1e-5, lambda_factor = 10, lambda_upper_bound = 1e5;
+        double min_model_fidelity = 1e-3;
+    };
+
+    /**
+     * GNC-TLS over a single SE(3) pose for Gaussian-to-Gaussian residuals, the problem gtsam::gncQuadricsSE3 builds
+     * as a factor graph of Gaussian2GaussianFactor. The residual of term k is
+     *     r_k = (R S1_k R^T + S2_k)^(-1/2) (R c1_k + t - c2_k),
+     * linearized with the same Jacobian as the factor (the covariance held fixed) and a right perturbation
+     * [w, v] of the pose. Each Levenberg-Marquardt step accumulates a 6x6 normal system on the stack, and the
+     * covariances are regularized once in makeTerm(), so solve() allocates nothing but the weights.
+     * The GNC schedule, the inner LM and their stopping rules follow GncOptimizer and LevenbergMarquardtOptimizer,
+     * including that every inner LM restarts from the initial pose.
+     */
+    class GaussianGncTlsSE3 {
+    public:
+        typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+        typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+        // one correspondence with its covariances already regularized, can be shared by several solvers
+        struct Term {
+            Eigen::Vector3d c1, c2;
+            Eigen::Matrix3d cov1, cov2;
+        };
+
+        /**
+         * @param plane replace the singular values of both covariances by (1, 1, 1e-3), as
+         * RegularizationMethod::PLANE does, otherwise they are used as they are (RegularizationMethod::NONE)
+         */
+        static Term makeTerm(const Eigen::Vector3d &src_center, const Eigen::Vector3d &tgt_center,
+                             const Eigen::Matrix3d &src_cov, const Eigen::Matrix3d &tgt_cov, bool plane) {
+            Term term;
+            term.c1 = src_center;
+            term.c2 = tgt_center;
+            term.cov1 = plane ? planeCov(src_cov) : src_cov;
+            term.cov2 = plane ? planeCov(tgt_cov) : tgt_cov;
+            return term;
+        }
+
+        explicit GaussianGncTlsSE3(const GncTlsParams &params = GncTlsParams()) : params_(params) {}
+
+        void reserve(size_t num_terms) {
+            terms_.reserve(num_terms);
+            weights_.reserve(num_terms);
+        }
+
+        void clear() {
+            terms_.clear();
+            weights_.clear();
+        }
+
+        void add(const Term &term) {
+            terms_.push_back(term);
+        }
+
+        void add(const Eigen::Vector3d &src_center, const Eigen::Vector3d &tgt_center, const Eigen::Matrix3d &src_cov,
+                 const Eigen::Matrix3d &tgt_cov, bool plane) {
+            terms_.push_back(makeTerm(src_center, tgt_center, src_cov, tgt_cov, plane));
+        }
+
+        size_t size() const {
+            return terms_.size();
+        }
+
+        Eigen::Matrix4d solve(const Eigen::Matrix4d &init) {
+            const Eigen::Matrix3d R0 = init.block<3, 3>(0, 0);
+            const Eigen::Vector3d t0 = init.block<3, 1>(0, 3);
+            weights_.assign(terms_.size(), 1.0);
+            Eigen::Matrix3d R = R0;
+            Eigen::Vector3d t = t0;
+            optimize(R, t);
+
+            // mu from the residuals at the initial pose, as GncOptimizer::initializeMu
+            double mu = std::numeric_limits<double>::infinity();
+            for (const auto &term: terms_) {
+                double rk = cost(term, R0, t0);
+                if (2 * rk - params_.barc_sq > 0) {
+                    mu = std::min(mu, params_.barc_sq / (2 * rk - params_.barc_sq));
+                }
+            }
+            if (mu >= 0 && mu < 1e-6) {
+                mu = 1e-6;
+            }
+            iterations_ = 0;
+            if (terms_.empty() || std::isinf(mu)) {
+                return toMatrix(R, t);
+            }
+
+            double prev_cost = weightedCost(R, t);
+            for (iterations_ = 0; iterations_ < params_.max_iterations; iterations_++) {
+                updateWeights(R, t, mu);
+                R = R0;
+                t = t0;
+                optimize(R, t);
+                double new_cost = weightedCost(R, t);
+                if (weightsConverged() ||
+                    std::abs(new_cost - prev_cost) / std::max(prev_cost, 1e-7) < params_.relative_cost_tol) {
+                    break;
+                }
+                mu *= params_.mu_step;
+                prev_cost = new_cost;
+            }
+            return toMatrix(R, t);
+        }
+
+        // TLS weights of the last solve, 1 for inliers and 0 for outliers once converged
+        const std::vector<double> &weights() const {
+            return weights_;
+        }
+
+        int iterations() const {
+            return iterations_;
+        }
+
+    private:
+        static Eigen::Matrix3d planeCov(const Eigen::Matrix3d &cov) {
+            Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU | Eigen::ComputeFullV);
+            return svd.matrixU() * Eigen::Vector3d(1, 1, 1e-3).asDiagonal() * svd.matrixV().transpose();
+        }
+
+        static Eigen::Matrix3d skew(const Eigen::Vector3d &v) {
+            Eigen::Matrix3d S;
+            S << 0, -v.z(), v.y(), v.z(), 0, -v.x(), -v.y(), v.x(), 0;
+            return S;
+        }
+
+        static Eigen::Matrix4d toMatrix(const Eigen::Matrix3d &R, const Eigen::Vector3d &t) {
+            Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+            T.block<3, 3>(0, 0) = R;
+            T.block<3, 1>(0, 3) = t;
+            return T;
+        }
+
+        // T * Exp([w, v]), the Pose3 retraction
+        static void retract(const Eigen::Matrix3d &R, const Eigen::Vector3d &t, const Vector6d &xi,
+                            Eigen::Matrix3d &R_new, Eigen::Vector3d &t_new) {
+            const Eigen::Vector3d w = xi.head<3>(), v = xi.tail<3>();
+            const double theta2 = w.squaredNorm();
+            const Eigen::Matrix3d W = skew(w);
+            Eigen::Matrix3d dR, V;
+            if (theta2 > std::numeric_limits<double>::epsilon()) {
+                const double theta = std::sqrt(theta2);
+                const double a = std::sin(theta) / theta, b = (1 - std::cos(theta)) / theta2;
+                dR = Eigen::Matrix3d::Identity() + a * W + b * W * W;
+                V = Eigen::Matrix3d::Identity() + b * W + (1 - a) / theta2 * W * W;
+            } else {
+                dR = Eigen::Matrix3d::Identity() + W;
+                V = Eigen::Matrix3d::Identity();
+            }
+            R_new = R * dR;
+            t_new = t + R * (V * v);
+        }
+
+        // 0.5 |r_k|^2, the error of Gaussian2GaussianFactor
+        static double cost(const Term &term, const Eigen::Matrix3d &R, const Eigen::Vector3d &t) {
+            const Eigen::Matrix3d info = (R * term.cov1 * R.transpose() + term.cov2).inverse();
+            const Eigen::Vector3d e = R * term.c1 + t - term.c2;
+            return 0.5 * e.dot(info * e);
+        }
+
+        double weightedCost(const Eigen::Matrix3d &R, const Eigen::Vector3d &t) const {
+            double total = 0;
+            for (size_t k = 0; k < terms_.size(); k++) {
+                if (weights_[k] > 0) {
+                    total += weights_[k] * cost(terms_[k], R, t);
+                }
+            }
+            return total;
+        }
+
+        // GncOptimizer::calculateWeights for the TLS loss
+        void updateWeights(const Eigen::Matrix3d &R, const Eigen::Vector3d &t, double mu) {
+            const double upper = (mu + 1) / mu * params_.barc_sq, lower = mu / (mu + 1) * params_.barc_sq;
+            for (size_t k = 0; k < terms_.size(); k++) {
+                double u2 = cost(terms_[k], R, t);
+                double w = std::sqrt(params_.barc_sq * mu * (mu + 1) / u2) - mu;
+                if (u2 >= upper || w < 0) {
+                    w = 0;
+                } else if (u2 <= lower || w > 1) {
+                    w = 1;
+                }
+                weights_[k] = w;
+            }
+        }
+
+        bool weightsConverged() const {
+            for (double w: weights_) {
+                if (std::abs(w - std::round(w)) > params_.weights_tol) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // weighted Gauss-Newton system J^T J, J^T r and the error at (R, t)
+        double linearize(const Eigen::Matrix3d &R, const Eigen::Vector3d &t, Matrix6d &H, Vector6d &g) const {
+            H.setZero();
+            g.setZero();
+            double error = 0;
+            Eigen::Matrix<double, 3, 6> B;
+            for (size_t k = 0; k < terms_.size(); k++) {
+                if (weights_[k] <= 0) {
+                    continue;
+                }
+                const Term &term = terms_[k];
+                const Eigen::Matrix3d info = weights_[k] * (R * term.cov1 * R.transpose() + term.cov2).inverse();
+                const Eigen::Vector3d e = R * term.c1 + t - term.c2;
+                B.leftCols<3>() = -R * skew(term.c1);
+                B.rightCols<3>() = R;
+                const Eigen::Matrix<double, 6, 3> BtI = B.transpose() * info;
+                H.noalias() += BtI * B;
+                g.noalias() += BtI * e;
+                error += 0.5 * e.dot(info * e);
+            }
+            return error;
+        }
+
+        // LevenbergMarquardtOptimizer with its default parameters and lambda * I damping
+        void optimize(Eigen::Matrix3d &R, Eigen::Vector3d &t) const {
+            Matrix6d H;
+            Vector6d g;
+            double lambda = params_.lambda_initial;
+            double error = linearize(R, t, H, g);
+            if (error <= 0) {
+                return;
+            }
+            for (int iter = 0; iter < params_.lm_max_iterations; iter++) {
+                double prev_error = error;
+                while (lambda < params_.lambda_upper_bound) {
+                    Eigen::LDLT<Matrix6d> ldlt(H + lambda * Matrix6d::Identity());
+                    if (ldlt.info() != Eigen::Success) {
+                        lambda *= params_.lambda_factor;
+                        continue;
+                    }
+                    const Vector6d delta = ldlt.solve(-g);
+                    const double linearized_change = -(g.dot(delta) + 0.5 * delta.dot(H * delta));
+                    bool success = false, stop = false;
+                    Eigen::Matrix3d R_new;
+                    Eigen::Vector3d t_new;
+                    double new_error = error;
+                    if (linearized_change >= 0) {
+                        retract(R, t, delta, R_new, t_new);
+                        new_error = weightedCost(R_new, t_new);
+                        double change = error - new_error;
+                        success = linearized_change > std::numeric_limits<double>::epsilon() * error ?
+                                  change / linearized_change > params_.min_model_fidelity : true;
+                        stop = std::abs(change) < params_.lm_relative_tol * error;
+                    }
+                    if (success) {
+                        lambda = std::max(0.0, lambda / params_.lambda_factor);
+                        R = R_new;
+                        t = t_new;
+                        error = linearize(R, t, H, g);
+                        break;
+                    }
+                    if (stop) {
+                        break;
+                    }
+                    lambda *= params_.lambda_factor;
+                }
+                if (error <= 0 || prev_error - error <= params_.lm_absolute_tol ||
+                    (prev_error - error) / prev_error <= params_.lm_relative_tol || !std::isfinite(error)) {
+                    break;
+                }
+            }
+        }
+
+        GncTlsParams params_;
+        std::vector<Term> terms_;
+        std::vector<double> weights_;
+        int iterations_ = 0;
+    };
+}
+
+#endif //SRC_GNC_SE3_H
@@ -0,0 +1,102 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_MAPPED_FILE_H
+#define SRC_MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace g3reg {
+
+    // read-only memory mapping of a whole file, unmapped on destruction
+    class MappedFile {
+    public:
+        MappedFile() = default;
+
+        explicit MappedFile(const std::string &path) {
+            open(path);
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        MappedFile(MappedFile &&other) noexcept: data_(other.data_), size_(other.size_) {
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+
+        MappedFile &operator=(MappedFile &&other) noexcept {
+            if (this != &other) {
+                close();
+                data_ = other.data_;
+                size_ = other.size_;
+                other.data_ = nullptr;
+                other.size_ = 0;
+            }
+            return *this;
+        }
+
+        ~MappedFile() {
+            close();
+        }
+
+        bool open(const std::string &path) {
+            close();
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                ::close(fd);
+                return false;
+            }
+            size_ = st.st_size;
+            if (size_ > 0) {
+                void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED) {
+                    ::close(fd);
+                    size_ = 0;
+                    return false;
+                }
+                data_ = static_cast<const char *>(addr);
+                // the whole file is read front to back right after mapping
+                madvise(addr, size_, MADV_SEQUENTIAL);
+            }
+            // the mapping stays valid after the descriptor is closed
+            ::close(fd);
+            return true;
+        }
+
+        void close() {
+            if (data_ != nullptr) {
+                munmap(const_cast<char *>(data_), size_);
+            }
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+        const char *data() const {
+            return data_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+    };
+}
+
+#endif //SRC_MAPPED_FILE_H
@@ -0,0 +1,82 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_MEMORY_H
+#define SRC_MEMORY_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace g3reg {
+
+    // a field of /proc/self/status in KiB, e.g. VmRSS or VmHWM (the peak RSS), -1 if unavailable
+    long ReadStatusKb(const std::string &field);
+
+    double CurrentRssMb();
+
+    // peak RSS since the last ResetPeakRss, including the peaks hidden by the resets of MemoryScope
+    double PeakRssMb();
+
+    // restart the peak RSS from the current RSS, supported since Linux 4.0
+    void ResetPeakRss();
+
+    /**
+     * Heap counters of the whole process. They are only maintained when built with G3REG_COUNT_ALLOCS, which
+     * replaces the glibc malloc family with counting wrappers; otherwise every counter reads 0.
+     */
+    struct HeapCounters {
+        size_t allocs = 0, alloc_bytes = 0;
+        size_t live_bytes = 0, peak_bytes = 0;  // peak since the last resetPeak
+
+        static bool enabled();
+
+        static HeapCounters read();
+
+        // restart the peak from the live bytes, returns the previous peak
+        static size_t resetPeak();
+
+        // raise the peak back to at least bytes
+        static void restorePeak(size_t bytes);
+    };
+
+    // memory used by one pipeline stage
+    struct StageMemory {
+        std::string stage;
+        size_t allocs = 0;              // heap allocations made in the stage
+        double alloc_mb = 0;            // bytes requested by these allocations
+        double peak_heap_mb = 0;        // highest live heap during the stage, above the live heap at its start
+        double rss_mb = 0;              // RSS at the end of the stage
+        double peak_rss_mb = 0;         // highest RSS during the stage
+    };
+
+    /**
+     * Attributes the allocations and the peak memory of the enclosing scope to a stage, appended to records when
+     * the scope closes. Scopes nest on one thread: an outer stage still sees the peaks of its inner stages.
+     * Reading /proc costs some tens of microseconds, so scopes belong around whole stages, not inner loops.
+     * A null records disables the scope.
+     */
+    class MemoryScope {
+    public:
+        MemoryScope(const char *stage, std::vector<StageMemory> *records);
+
+        ~MemoryScope();
+
+        MemoryScope(const MemoryScope &) = delete;
+
+        MemoryScope &operator=(const MemoryScope &) = delete;
+
+    private:
+        const char *stage_;
+        std::vector<StageMemory> *records_;
+        MemoryScope *parent_ = nullptr;
+        HeapCounters begin_;
+        size_t heap_peak_before_ = 0;
+        double rss_peak_before_ = 0, child_rss_peak_ = 0;
+    };
+}
+
+#endif //SRC_MEMORY_H
@@ -8,6 +8,7 @@
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
 #include "front_end/gem/gemodel.h"
+#include "utils/gnc_se3.h"
 
 namespace gtsam {
 
@@ -170,6 +171,16 @@ namespace gtsam {
                                    clique_solver::Association &assoc,
                                    Eigen::Matrix4d init = Eigen::Matrix4d::Identity());
 
+    // same problem as gncQuadricsSE3, solved by the fixed-size engine of utils/gnc_se3.h without a factor graph
+    Eigen::Matrix4d fusedGncQuadricsSE3(const std::vector<g3reg::QuadricFeature::Ptr> &src,
+                                        const std::vector<g3reg::QuadricFeature::Ptr> &tgt,
+                                        const clique_solver::Association &assoc,
+                                        Eigen::Matrix4d init = Eigen::Matrix4d::Identity());
+
+    // the regularized term of one quadric association, false if the types differ or are unknown
+    bool quadricTerm(const g3reg::QuadricFeature::Ptr &src, const g3reg::QuadricFeature::Ptr &tgt,
+                     g3reg::GaussianGncTlsSE3::Term &term);
+
     Eigen::Matrix4d gncSE3(const Eigen::Matrix3Xd &src, const Eigen::Matrix3Xd &tgt,
                            Eigen::Matrix4d init = Eigen::Matrix4d::Identity());
 
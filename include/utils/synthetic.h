@@ -0,0 +1,110 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_SYNTHETIC_H
+#define SRC_SYNTHETIC_H
+
+#include <vector>
+#include <Eigen/Core>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+
+namespace g3reg {
+
+    // layout of a straight urban street along the x axis of the world frame
+    struct SceneParams {
+        unsigned seed = 0;
+        double street_length = 240;     // facades and objects cover x in [-length/2, length/2]
+        double facade_offset = 12;      // distance of the facades from the street center line
+        double pole_offset = 8;
+        double pole_spacing = 15;
+        int num_cars = 24;
+        int num_trees = 16;
+    };
+
+    // spinning lidar, one ray per (beam, azimuth)
+    struct LidarParams {
+        int num_beams = 64;
+        int num_azimuths = 1024;
+        double min_elevation = -24.8;   // deg
+        double max_elevation = 2.0;     // deg
+        double min_range = 0.5, max_range = 80;
+        double range_noise = 0.02;      // standard deviation, m
+    };
+
+    /**
+     * Ray-cast scenes built from the ground plane, box facades and cars, and vertical cylinders for poles and
+     * tree trunks. Every scan and scene is a pure function of the seeds, so fixtures are reproducible.
+     */
+    class SyntheticScene {
+    public:
+        explicit SyntheticScene(const SceneParams &params = SceneParams());
+
+        /**
+         * Scan the scene from a sensor pose.
+         * @param pose sensor-to-world transform, the ground is the plane z = 0 of the world frame
+         * @return points in the sensor frame
+         */
+        pcl::PointCloud<pcl::PointXYZ>::Ptr scan(const Eigen::Matrix4d &pose, const LidarParams &lidar = LidarParams(),
+                                                 unsigned seed = 0) const;
+
+        size_t numPrimitives() const {
+            return boxes_.size() + cylinders_.size() + 1;
+        }
+
+    private:
+        struct Box {
+            Eigen::Vector3d min, max;
+        };
+
+        struct Cylinder {
+            Eigen::Vector2d center;
+            double radius, z_min, z_max;
+        };
+
+        // distance along the unit ray to the first hit, or max_range if none
+        double castRay(const Eigen::Vector3d &origin, const Eigen::Vector3d &dir, double max_range) const;
+
+        SceneParams params_;
+        std::vector<Box> boxes_;
+        std::vector<Cylinder> cylinders_;
+    };
+
+    // a lidar pose on the street, yaw in degrees
+    Eigen::Matrix4d StreetPose(double x, double y, double yaw_deg, double sensor_height = 1.73);
+
+    struct CorrespondenceParams {
+        unsigned seed = 0;
+        int num_corrs = 1000;
+        double outlier_ratio = 0.9;
+        double noise = 0.05;            // standard deviation of the inlier noise, m
+        double max_rotation = 30;       // deg, about a random axis
+        double max_tilt = -1;           // deg, if >= 0 max_rotation is a yaw and roll and pitch stay below max_tilt
+        double max_translation = 10;    // m
+    };
+
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> PointRows;
+
+    // correspondences with a known transform, row i of src matches row i of tgt
+    struct SyntheticCorrespondences {
+        PointRows src, tgt;
+        Eigen::Matrix4d T;              // maps src to tgt
+        std::vector<char> inlier;
+    };
+
+    /**
+     * Draw correspondences whose sources are points of a cloud (e.g. a synthetic scan), so that they keep the
+     * structure of real scenes. Inliers are T * src plus gaussian noise, outliers are random points of the cloud
+     * moved by T, i.e. wrong matches that still lie on the target scene.
+     * @param tgt_cloud if not null, receives the whole cloud transformed by T with the same noise
+     * @throw std::runtime_error if the cloud is empty
+     */
+    SyntheticCorrespondences GenerateCorrespondences(const pcl::PointCloud<pcl::PointXYZ> &cloud,
+                                                     const CorrespondenceParams &params,
+                                                     pcl::PointCloud<pcl::PointXYZ> *tgt_cloud = nullptr);
+}
+
+#endif //SRC_SYNTHETIC_H
@@ -0,0 +1,123 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#ifndef SRC_TRACE_H
+#define SRC_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace g3reg {
+
+    // one closed span, begin and end in nanoseconds of the steady clock
+    struct TraceSpan {
+        const char *name;
+        int arg;     // e.g. the graph level, -1 if unused
+        int depth;   // nesting depth on the recording thread
+        int64_t begin_ns, end_ns;
+    };
+
+    // latency distribution of all spans with the same name (and arg)
+    struct TraceStats {
+        std::string stage;
+        size_t count = 0;
+        double total_ms = 0, mean_ms = 0, p50_ms = 0, p90_ms = 0, p99_ms = 0, max_ms = 0;
+    };
+
+    /**
+     * Records nested spans of every thread. Each thread appends to its own buffer, so recording takes no lock
+     * after the first span of a thread. When disabled a span costs one relaxed atomic load.
+     * The buffers may only be read (statistics, save*) or cleared while no span is open.
+     */
+    class Tracer {
+    public:
+        static Tracer &instance();
+
+        static bool enabled() {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        void setEnabled(bool enabled);
+
+        void clear();
+
+        // spans of all threads sorted by name, arg
+        std::vector<TraceStats> statistics() const;
+
+        // Chrome trace event format, open with chrome://tracing or ui.perfetto.dev
+        bool saveChromeTrace(const std::string &path) const;
+
+        bool saveStatistics(const std::string &path) const;
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        friend class TraceScope;
+
+        struct ThreadBuffer {
+            int tid = 0;
+            int depth = 0;
+            std::vector<TraceSpan> spans;
+        };
+
+        ThreadBuffer &threadBuffer();
+
+        static std::atomic<bool> enabled_;
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+        int64_t origin_ns_ = now();
+    };
+
+    // records the enclosing scope as one span, name must outlive the tracer (a string literal)
+    class TraceScope {
+    public:
+        explicit TraceScope(const char *name, int arg = -1) {
+            if (Tracer::enabled()) {
+                buffer_ = &Tracer::instance().threadBuffer();
+                name_ = name;
+                arg_ = arg;
+                depth_ = buffer_->depth++;
+                begin_ns_ = Tracer::now();
+            }
+        }
+
+        ~TraceScope() {
+            if (buffer_ != nullptr) {
+                buffer_->spans.push_back({name_, arg_, depth_, begin_ns_, Tracer::now()});
+                buffer_->depth--;
+            }
+        }
+
+        TraceScope(const TraceScope &) = delete;
+
+        TraceScope &operator=(const TraceScope &) = delete;
+
+    private:
+        Tracer::ThreadBuffer *buffer_ = nullptr;
+        const char *name_ = nullptr;
+        int arg_ = -1, depth_ = 0;
+        int64_t begin_ns_ = 0;
+    };
+}
+
+#define G3REG_TRACE_CONCAT_(a, b) a##b
+#define G3REG_TRACE_CONCAT(a, b) G3REG_TRACE_CONCAT_(a, b)
+#ifdef G3REG_NO_TRACE
+#define G3REG_TRACE_SCOPE(...)
+#else
+// G3REG_TRACE_SCOPE("stage") or G3REG_TRACE_SCOPE("stage", level)
+#define G3REG_TRACE_SCOPE(...) g3reg::TraceScope G3REG_TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
+#endif
+
+#endif //SRC_TRACE_H
@@ -1,10 +1,13 @@
 #include "back_end/mac3d/mac_reg.h"
+#include "utils/opt_utils.h"
+#include <chrono>
+#include <numeric>
 
 namespace mac_reg {
     Eigen::Matrix4d MaximalCliqueReg::run() {
 
-        Eigen::MatrixXf Graph = Graph_construction(correspondence, use_sc2);
-        if (Graph.norm() == 0) {
+        SpGraph Graph = Graph_construction(correspondence, use_sc2);
+        if (Graph.nonZeros() == 0) {
             LOG(INFO) << "Graph is disconnected.";
             return Eigen::Matrix4d::Identity();
         }
@@ -16,11 +19,9 @@ namespace mac_reg {
             Vote_exp t;
             t.true_num = 0;
             std::vector<int> corre_index;
-            for (int j = 0; j < total_num; j++) {
-                if (i != j && Graph(i, j)) {
-                    degree[i]++;
-                    corre_index.push_back(j);
-                }
+            for (SpGraph::InnerIterator it(Graph, i); it; ++it) {
+                degree[i]++;
+                corre_index.push_back(it.col());
             }
             t.index = i;
             t.degree = degree[i];
@@ -33,40 +34,17 @@ namespace mac_reg {
         double sum_fenzi = 0;
         double sum_fenmu = 0;
         omp_set_num_threads(12);
+        Eigen::VectorXd triangle_weights;
+        Eigen::VectorXd coefficients = clustering_coefficients(Graph, triangle_weights);
         for (int i = 0; i < total_num; i++) {
             Vote t;
-            double sum_i = 0;
-            double wijk = 0;
-            int index_size = pts_degree[i].corre_index.size();
-#pragma omp parallel
-            {
-#pragma omp for
-                for (int j = 0; j < index_size; j++) {
-                    int a = pts_degree[i].corre_index[j];
-                    for (int k = j + 1; k < index_size; k++) {
-                        int b = pts_degree[i].corre_index[k];
-                        if (Graph(a, b)) {
-#pragma omp critical
-                            wijk += pow(Graph(i, a) * Graph(i, b) * Graph(a, b), 1.0 / 3); //wij + wik
-                        }
-                    }
-                }
-            }
-
+            t.index = i;
+            t.score = coefficients[i];
             if (degree[i] > 1) {
-                double f1 = wijk;
-                double f2 = degree[i] * (degree[i] - 1) * 0.5;
-                sum_fenzi += f1;
-                sum_fenmu += f2;
-                double factor = f1 / f2;
-                t.index = i;
-                t.score = factor;
-                cluster_factor.push_back(t);
-            } else {
-                t.index = i;
-                t.score = 0;
-                cluster_factor.push_back(t);
+                sum_fenzi += triangle_weights[i];
+                sum_fenmu += degree[i] * (degree[i] - 1) * 0.5;
             }
+            cluster_factor.push_back(t);
         }
         double average_factor = 0;
         for (size_t i = 0; i < cluster_factor.size(); i++) {
@@ -103,14 +81,7 @@ namespace mac_reg {
         }
 
         //GTM 筛选
-        std::vector<int> Match_inlier;
-        /*****************************************igraph**************************************************/
-        igraph_t g;
-        igraph_matrix_t g_mat;
-        igraph_vector_t weights;
-        igraph_vector_init(&weights, Graph.rows() * (Graph.cols() - 1) / 2);
-        igraph_matrix_init(&g_mat, Graph.rows(), Graph.cols());
-
+        std::vector<char> node_active(total_num, 1);
         if (cluster_threshold > 3 &&
             correspondence.size() > 50/*max(OTSU, total_factor) > 0.3*/) //reduce the graph size
         {
@@ -122,82 +93,36 @@ namespace mac_reg {
                     break;
                 }
             }
-            for (int i = 0; i < Graph.rows(); i++) {
-                if (cluster_factor_bac[i].score > f * std::max(OTSU, total_factor)) {
-                    for (int j = i + 1; j < Graph.cols(); j++) {
-                        if (cluster_factor_bac[j].score > f * std::max(OTSU, total_factor)) {
-                            MATRIX(g_mat, i, j) = Graph(i, j);
-                        }
-                    }
-                }
-            }
-        } else {
-            for (int i = 0; i < Graph.rows(); i++) {
-                for (int j = i + 1; j < Graph.cols(); j++) {
-                    if (Graph(i, j)) {
-                        MATRIX(g_mat, i, j) = Graph(i, j);
-                    }
-                }
+            for (int i = 0; i < total_num; i++) {
+                node_active[i] = cluster_factor_bac[i].score > f * std::max(OTSU, total_factor);
             }
         }
 
-        igraph_set_attribute_table(&igraph_cattribute_table);
-        igraph_weighted_adjacency(&g, &g_mat, IGRAPH_ADJ_UNDIRECTED, 0, 1);
-        const char *att = "weight";
-        EANV(&g, att, &weights);
-
-        //find all maximal cliques
-        igraph_vector_ptr_t cliques;
-        igraph_vector_ptr_init(&cliques, 0);
-
-        igraph_maximal_cliques(&g, &cliques, 3, 0); //3dlomatch 4 3dmatch; 3 Kitti  4
-        int clique_num = igraph_vector_ptr_size(&cliques);
-        if (clique_num == 0) {
+        std::vector<std::vector<int>> cliques = node_guided_cliques(Graph, node_active);
+        if (cliques.empty()) {
             std::cerr << " NO CLIQUES! " << std::endl;
         }
 
-        //clear useless data
-        igraph_destroy(&g);
-        igraph_matrix_destroy(&g_mat);
-        igraph_vector_destroy(&weights);
-
-        std::vector<int> remain;
-        for (int i = 0; i < clique_num; i++) {
-            remain.push_back(i);
-        }
-        node_cliques *N_C = new node_cliques[(int) total_num];
-        int max_est_num = INT_MAX;
-        find_largest_clique_of_node(Graph, &cliques, correspondence, N_C, remain, total_num, max_est_num);
-
         pcl::PointCloud<pcl::PointXYZ>::Ptr src_corr_pts(new pcl::PointCloud<pcl::PointXYZ>);
         pcl::PointCloud<pcl::PointXYZ>::Ptr des_corr_pts(new pcl::PointCloud<pcl::PointXYZ>);
+        Eigen::Matrix3Xd src_mat(3, total_num), des_mat(3, total_num);
         for (size_t i = 0; i < correspondence.size(); i++) {
             src_corr_pts->push_back(correspondence[i].src);
             des_corr_pts->push_back(correspondence[i].des);
+            src_mat.col(i) = correspondence[i].src.getVector3fMap().cast<double>();
+            des_mat.col(i) = correspondence[i].des.getVector3fMap().cast<double>();
         }
 
         /******************************************registraion***************************************************/
-        Eigen::Matrix4d best_est;
+        // every distinct clique is one hypothesis, identical cliques were merged in node_guided_cliques
+        Eigen::Matrix4d best_est = Eigen::Matrix4d::Identity();
         double best_score = 0;
         double inlier_thresh = 0.6;
-        std::vector<Corre_3DMatch> selected;
-        std::vector<int> corre_index;
-#pragma omp parallel for
-        for (int i = 0; i < remain.size(); i++) {
-            std::vector<Corre_3DMatch> Group;
-            std::vector<int> selected_index;
-            igraph_vector_t *v = (igraph_vector_t *) VECTOR(cliques)[remain[i]];
-            int group_size = igraph_vector_size(v);
-            for (int j = 0; j < group_size; j++) {
-                Corre_3DMatch C = correspondence[VECTOR(*v)[j]];
-                Group.push_back(C);
-                selected_index.push_back(VECTOR(*v)[j]);
-            }
-            //igraph_vector_destroy(v);
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < cliques.size(); i++) {
             Eigen::Matrix4d est_trans;
             //evaluate cliques
-            double score = evaluation_trans(Group, src_corr_pts, des_corr_pts, weight_thresh, est_trans,
-                                            inlier_thresh);
+            double score = evaluation_trans(cliques[i], src_mat, des_mat, weight_thresh, est_trans, inlier_thresh);
             //GT未知
             if (score > 0) {
 #pragma omp critical
@@ -205,18 +130,10 @@ namespace mac_reg {
                     if (best_score < score) {
                         best_score = score;
                         best_est = est_trans;
-                        selected = Group;
-                        corre_index = selected_index;
                     }
                 }
             }
-            Group.clear();
-            Group.shrink_to_fit();
-            selected_index.clear();
-            selected_index.shrink_to_fit();
         }
-        //free memory
-        igraph_vector_ptr_destroy(&cliques);
         post_refinement(src_corr_pts, des_corr_pts, best_est, best_score, inlier_thresh, 20, "MAE");
 
         correspondence.clear();
@@ -231,48 +148,144 @@ namespace mac_reg {
         cluster_factor.shrink_to_fit();
         cluster_factor_bac.clear();
         cluster_factor_bac.shrink_to_fit();
-        delete[] N_C;
-        remain.clear();
-        remain.shrink_to_fit();
-        selected.clear();
-        selected.shrink_to_fit();
-        corre_index.clear();
-        corre_index.shrink_to_fit();
+        cliques.clear();
+        cliques.shrink_to_fit();
         src_corr_pts.reset(new pcl::PointCloud<pcl::PointXYZ>);
         des_corr_pts.reset(new pcl::PointCloud<pcl::PointXYZ>);
         return best_est;
     }
 
-    Eigen::MatrixXf MaximalCliqueReg::Graph_construction(std::vector<Corre_3DMatch> &correspondence, bool sc2) {
+    MaximalCliqueReg::SpGraph
+    MaximalCliqueReg::Graph_construction(std::vector<Corre_3DMatch> &correspondence, bool sc2) {
         int size = correspondence.size();
-        Eigen::MatrixXf cmp_score;
-        cmp_score.resize(size, size);
-        cmp_score.setZero();
-        Corre_3DMatch c1, c2;
-        float score, src_dis, des_dis, dis, alpha_dis;
         float thresh = 0.9; //fcgf 0.999 fpfh 0.9
+        // most pairs fall below the threshold, so only the compatible upper-triangle pairs of each row are kept
+        std::vector<std::vector<std::pair<int, float>>> upper(size);
+#pragma omp parallel for schedule(dynamic, 16)
         for (int i = 0; i < size; i++) {
-            c1 = correspondence[i];
+            const Corre_3DMatch &c1 = correspondence[i];
             for (int j = i + 1; j < size; j++) {
-                c2 = correspondence[j];
-                src_dis = Distance(c1.src, c2.src);
-                des_dis = Distance(c1.des, c2.des);
-                dis = abs(src_dis - des_dis);
-                score = 1 - (dis * dis) / (0.6 * 0.6);
+                const Corre_3DMatch &c2 = correspondence[j];
+                float src_dis = Distance(c1.src, c2.src);
+                float des_dis = Distance(c1.des, c2.des);
+                float dis = std::abs(src_dis - des_dis);
+                float score = 1 - (dis * dis) / (0.6 * 0.6);
                 //score = exp(-dis * dis);
-                score = (score < thresh) ? 0 : score;//fcgf 0.9999 fpfh 0.9
-                cmp_score(i, j) = score;
-                cmp_score(j, i) = score;
+                if (score >= thresh) { //fcgf 0.9999 fpfh 0.9
+                    upper[i].emplace_back(j, score);
+                }
+            }
+        }
 
+        // mirror into a symmetric CSR matrix, rows stay sorted since i is visited in ascending order
+        SpGraph cmp_score(size, size);
+        int *offsets = cmp_score.outerIndexPtr();
+        offsets[0] = 0;
+        std::vector<int> degree(size, 0);
+        for (int i = 0; i < size; i++) {
+            degree[i] += upper[i].size();
+            for (const auto &edge: upper[i]) {
+                degree[edge.first]++;
             }
         }
+        for (int i = 0; i < size; i++) {
+            offsets[i + 1] = offsets[i] + degree[i];
+        }
+        cmp_score.resizeNonZeros(offsets[size]);
+        int *neighbors = cmp_score.innerIndexPtr();
+        float *scores = cmp_score.valuePtr();
+        std::vector<int> cursor(offsets, offsets + size);
+        for (int i = 0; i < size; i++) {
+            for (const auto &edge: upper[i]) {
+                int j = edge.first;
+                neighbors[cursor[i]] = j;
+                scores[cursor[i]++] = edge.second;
+                neighbors[cursor[j]] = i;
+                scores[cursor[j]++] = edge.second;
+            }
+            std::vector<std::pair<int, float>>().swap(upper[i]);
+        }
+
         if (sc2) {
-            //Eigen::setNbThreads(6);
-            cmp_score = cmp_score.cwiseProduct(cmp_score * cmp_score);
+            // SC^2 = A .* (A * A): (A * A)(i, j) is only needed on existing edges, where it is the sparse dot
+            // product of the sorted rows i and j
+            std::vector<float> sc2_scores(offsets[size], 0);
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int i = 0; i < size; i++) {
+                for (int p = offsets[i]; p < offsets[i + 1]; p++) {
+                    int j = neighbors[p];
+                    if (j < i) continue;
+                    float dot = 0;
+                    int a = offsets[i], b = offsets[j];
+                    while (a < offsets[i + 1] && b < offsets[j + 1]) {
+                        if (neighbors[a] < neighbors[b]) {
+                            a++;
+                        } else if (neighbors[a] > neighbors[b]) {
+                            b++;
+                        } else {
+                            dot += scores[a++] * scores[b++];
+                        }
+                    }
+                    sc2_scores[p] = scores[p] * dot;
+                }
+            }
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int i = 0; i < size; i++) {
+                for (int p = offsets[i]; p < offsets[i + 1]; p++) {
+                    int j = neighbors[p];
+                    if (j > i) break;
+                    int q = std::lower_bound(neighbors + offsets[j], neighbors + offsets[j + 1], i) - neighbors;
+                    sc2_scores[p] = sc2_scores[q];
+                }
+            }
+            std::copy(sc2_scores.begin(), sc2_scores.end(), scores);
+            // edges without any common neighbour drop out, as they did in the dense product
+            cmp_score.prune([](const int &, const int &, const float &value) { return value != 0; });
         }
         return cmp_score;
     }
 
+    Eigen::VectorXd MaximalCliqueReg::clustering_coefficients(const SpGraph &Graph, Eigen::VectorXd &triangle_weights) {
+        int num_node = Graph.rows();
+        const int *offsets = Graph.outerIndexPtr();
+        const int *neighbors = Graph.innerIndexPtr();
+        // cbrt(w_ia * w_ib * w_ab) = cbrt(w_ia) * cbrt(w_ib) * cbrt(w_ab), so one cube root per edge suffices
+        std::vector<double> cbrt_weights(Graph.nonZeros());
+#pragma omp parallel for
+        for (int p = 0; p < Graph.nonZeros(); p++) {
+            cbrt_weights[p] = std::cbrt((double) Graph.valuePtr()[p]);
+        }
+        Eigen::VectorXd coefficients = Eigen::VectorXd::Zero(num_node);
+        triangle_weights = Eigen::VectorXd::Zero(num_node);
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int i = 0; i < num_node; i++) {
+            int degree = offsets[i + 1] - offsets[i];
+            if (degree < 2) continue;
+            double wijk = 0;
+            // every triangle (i, a, b) with a < b is found once by merging the tail of row i after a with row a
+            for (int pa = offsets[i]; pa < offsets[i + 1]; pa++) {
+                int a = neighbors[pa];
+                double w_ia = cbrt_weights[pa], w_a = 0;
+                int pb = pa + 1, q = offsets[a];
+                while (pb < offsets[i + 1] && q < offsets[a + 1]) {
+                    if (neighbors[pb] < neighbors[q]) {
+                        pb++;
+                    } else if (neighbors[pb] > neighbors[q]) {
+                        q++;
+                    } else {
+                        w_a += cbrt_weights[pb] * cbrt_weights[q]; //wij + wik
+                        pb++;
+                        q++;
+                    }
+                }
+                wijk += w_a * w_ia;
+            }
+            triangle_weights[i] = wijk;
+            coefficients[i] = wijk / (degree * (degree - 1) * 0.5);
+        }
+        return coefficients;
+    }
+
     void MaximalCliqueReg::post_refinement(pcl::PointCloud<pcl::PointXYZ>::Ptr &src_corr_pts,
                                            pcl::PointCloud<pcl::PointXYZ>::Ptr &des_corr_pts,
                                            Eigen::Matrix4d &initial, double &best_score, double inlier_thresh,
@@ -326,7 +339,7 @@ namespace mac_reg {
         best_score = pre_score;
     }
 
-    double MaximalCliqueReg::Distance(pcl::PointXYZ &A, pcl::PointXYZ &B) {
+    double MaximalCliqueReg::Distance(const pcl::PointXYZ &A, const pcl::PointXYZ &B) {
         double distance = 0;
         double d_x = (double) A.x - (double) B.x;
         double d_y = (double) A.y - (double) B.y;
@@ -380,135 +393,231 @@ namespace mac_reg {
         return thresh;
     }
 
-    void
-    MaximalCliqueReg::find_largest_clique_of_node(Eigen::MatrixXf &Graph, igraph_vector_ptr_t *cliques,
-                                                  std::vector<Corre_3DMatch> &correspondence,
-                                                  node_cliques *result, std::vector<int> &remain, int num_node,
-                                                  int est_num) {
-        int *vis = new int[igraph_vector_ptr_size(cliques)];
-        memset(vis, 0, igraph_vector_ptr_size(cliques));
-#pragma omp parallel for
-        for (int i = 0; i < num_node; i++) {
-            result[i].clique_index = -1;
-            result[i].clique_size = 0;
-            result[i].clique_weight = 0;
-            result[i].clique_num = 0;
+    /**
+     * Branch and bound for the heaviest clique containing one node. Edge weights are positive, so the heaviest
+     * clique is also maximal. A greedy clique seeds the lower bound, which is all a node keeps once the branch
+     * budget or the deadline is exhausted.
+     */
+    class NodeCliqueSearch {
+    public:
+        NodeCliqueSearch(const std::vector<int> &offsets, const std::vector<int> &neighbors,
+                         const std::vector<float> &weights, float max_weight,
+                         const MaximalCliqueReg::CliqueSearchParams &params,
+                         const std::chrono::steady_clock::time_point &deadline)
+                : offsets_(offsets), neighbors_(neighbors), weights_(weights), max_weight_(max_weight),
+                  params_(params), deadline_(deadline) {}
+
+        float search(int node, std::vector<int> &best_clique) {
+            best_weight_ = 0;
+            best_clique_.clear();
+            branches_ = 0;
+            std::vector<Candidate> candidates;
+            candidates.reserve(offsets_[node + 1] - offsets_[node]);
+            for (int p = offsets_[node]; p < offsets_[node + 1]; p++) {
+                candidates.push_back({neighbors_[p], weights_[p]});
+            }
+            clique_.assign(1, node);
+            greedy(candidates);
+            if (std::chrono::steady_clock::now() < deadline_) {
+                expand(candidates, 0);
+            }
+            best_clique = best_clique_;
+            std::sort(best_clique.begin(), best_clique.end());
+            return best_weight_;
         }
 
-        for (int i = 0; i < remain.size(); i++) {
-            igraph_vector_t *v = (igraph_vector_t *) VECTOR(*cliques)[remain[i]];
-            float weight = 0;
-            int length = igraph_vector_size(v);
-            for (int j = 0; j < length; j++) {
-                int a = (int) VECTOR(*v)[j];
-                for (int k = j + 1; k < length; k++) {
-                    int b = (int) VECTOR(*v)[k];
-                    weight += Graph(a, b);
+    private:
+        // a vertex adjacent to the whole current clique, gain is the weight it would add to the clique
+        struct Candidate {
+            int node;
+            float gain;
+        };
+
+        // candidates adjacent to u, both lists are sorted by node index
+        void intersect(const std::vector<Candidate> &candidates, const std::vector<char> &excluded, int u,
+                       std::vector<Candidate> &result) {
+            result.clear();
+            size_t a = 0;
+            int b = offsets_[u];
+            while (a < candidates.size() && b < offsets_[u + 1]) {
+                if (candidates[a].node < neighbors_[b]) {
+                    a++;
+                } else if (candidates[a].node > neighbors_[b]) {
+                    b++;
+                } else {
+                    if (excluded.empty() || !excluded[a]) {
+                        result.push_back({candidates[a].node, candidates[a].gain + weights_[b]});
+                    }
+                    a++;
+                    b++;
                 }
             }
-            for (int j = 0; j < length; j++) {
-                int k = (int) VECTOR(*v)[j];
-                if (result[k].clique_weight < weight) {
-                    result[k].clique_index = remain[i];
-                    vis[remain[i]]++;
-                    result[k].clique_size = length;
-                    result[k].clique_weight = weight;
-                }
+        }
+
+        void record(float weight) {
+            if (clique_.size() >= params_.min_clique_size && weight > best_weight_) {
+                best_weight_ = weight;
+                best_clique_ = clique_;
             }
         }
 
-#pragma omp parallel for
-        for (int i = 0; i < remain.size(); i++) {
-            if (vis[remain[i]] == 0) {
-                igraph_vector_t *v = (igraph_vector_t *) VECTOR(*cliques)[remain[i]];
-                igraph_vector_destroy(v);
+        void greedy(std::vector<Candidate> candidates) {
+            float weight = 0;
+            std::vector<Candidate> next;
+            while (!candidates.empty()) {
+                const Candidate &best = *std::max_element(candidates.begin(), candidates.end(),
+                                                          [](const Candidate &a, const Candidate &b) {
+                                                              return a.gain < b.gain;
+                                                          });
+                weight += best.gain;
+                clique_.push_back(best.node);
+                intersect(candidates, {}, best.node, next);
+                candidates.swap(next);
             }
+            record(weight);
+            clique_.resize(1);
         }
 
-        std::vector<int> after_delete;
-        for (int i = 0; i < num_node; i++) {
-            if (result[i].clique_index < 0) {
-                continue;
+        void expand(const std::vector<Candidate> &candidates, float weight) {
+            if (candidates.empty()) {
+                record(weight);
+                return;
             }
-            if (vis[result[i].clique_index] > 0) {
-                vis[result[i].clique_index] = 0;
-                after_delete.push_back(result[i].clique_index);
-            } else if (vis[result[i].clique_index] == 0) {
-                result[i].clique_index = -1;
+            if (params_.max_branches > 0 && ++branches_ > params_.max_branches) {
+                return;
+            }
+            // heaviest candidates first, so that good cliques tighten the bound early
+            std::vector<int> order(candidates.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&candidates](int a, int b) {
+                return candidates[a].gain > candidates[b].gain;
+            });
+            double remaining_gain = 0;
+            for (const auto &c: candidates) {
+                remaining_gain += c.gain;
+            }
+            size_t remaining = candidates.size();
+            std::vector<char> excluded(candidates.size(), 0);
+            std::vector<Candidate> next;
+            for (int idx: order) {
+                // upper bound: every remaining candidate joins and every pair among them has the largest weight
+                double bound = weight + remaining_gain + 0.5 * remaining * (remaining - 1) * max_weight_;
+                if (bound <= best_weight_ || (params_.max_branches > 0 && branches_ > params_.max_branches) ||
+                    std::chrono::steady_clock::now() > deadline_) {
+                    break;
+                }
+                const Candidate &u = candidates[idx];
+                excluded[idx] = 1;
+                intersect(candidates, excluded, u.node, next);
+                clique_.push_back(u.node);
+                expand(next, weight + u.gain);
+                clique_.pop_back();
+                remaining_gain -= u.gain;
+                remaining--;
             }
         }
-        remain.clear();
-        remain = after_delete;
 
-        //reduce the number of cliques
-        if (remain.size() > est_num) {
-            std::vector<int> after_decline;
-            std::vector<Vote> clique_score;
+        const std::vector<int> &offsets_;
+        const std::vector<int> &neighbors_;
+        const std::vector<float> &weights_;
+        float max_weight_;
+        const MaximalCliqueReg::CliqueSearchParams &params_;
+        std::chrono::steady_clock::time_point deadline_;
+
+        std::vector<int> clique_, best_clique_;
+        float best_weight_ = 0;
+        int branches_ = 0;
+    };
+
+    std::vector<std::vector<int>>
+    MaximalCliqueReg::node_guided_cliques(const SpGraph &Graph, const std::vector<char> &node_active) {
+        int num_node = Graph.rows();
+        // CSR restricted to the edges between active nodes
+        std::vector<int> offsets(num_node + 1, 0), neighbors;
+        std::vector<float> weights;
+        neighbors.reserve(Graph.nonZeros());
+        weights.reserve(Graph.nonZeros());
+        float max_weight = 0;
+        for (int i = 0; i < num_node; i++) {
+            if (node_active[i]) {
+                for (SpGraph::InnerIterator it(Graph, i); it; ++it) {
+                    if (node_active[it.col()]) {
+                        neighbors.push_back(it.col());
+                        weights.push_back(it.value());
+                        max_weight = std::max(max_weight, it.value());
+                    }
+                }
+            }
+            offsets[i + 1] = neighbors.size();
+        }
+
+        std::vector<std::vector<int>> node_clique(num_node);
+        std::vector<float> node_weight(num_node, 0);
+        auto deadline = clique_params.time_limit > 0 ?
+                        std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(int64_t(clique_params.time_limit * 1000)) :
+                        std::chrono::steady_clock::time_point::max();
+#pragma omp parallel
+        {
+            NodeCliqueSearch searcher(offsets, neighbors, weights, max_weight, clique_params, deadline);
+#pragma omp for schedule(dynamic, 8)
             for (int i = 0; i < num_node; i++) {
-                if (result[i].clique_index < 0) {
-                    continue;
+                if (offsets[i + 1] - offsets[i] + 1 >= clique_params.min_clique_size) {
+                    node_weight[i] = searcher.search(i, node_clique[i]);
                 }
-                Vote t;
-                t.index = result[i].clique_index;
-                t.score = result[i].clique_weight;
-                clique_score.push_back(t);
             }
-            sort(clique_score.begin(), clique_score.end(), compare_vote_score);
-            for (int i = 0; i < est_num; i++) {
-                after_decline.push_back(clique_score[i].index);
+        }
+
+        // members of a clique usually select the same one, keep each distinct clique once
+        std::vector<int> owners;
+        for (int i = 0; i < num_node; i++) {
+            if (!node_clique[i].empty()) {
+                owners.push_back(i);
             }
-            remain.clear();
-            remain = after_decline;
-            clique_score.clear();
         }
-        delete[] vis;
-        return;
+        std::sort(owners.begin(), owners.end(), [&node_clique](int a, int b) {
+            return node_clique[a] < node_clique[b];
+        });
+        owners.erase(std::unique(owners.begin(), owners.end(), [&node_clique](int a, int b) {
+            return node_clique[a] == node_clique[b];
+        }), owners.end());
+
+        //reduce the number of cliques
+        if (clique_params.max_cliques > 0 && owners.size() > clique_params.max_cliques) {
+            std::nth_element(owners.begin(), owners.begin() + clique_params.max_cliques, owners.end(),
+                             [&node_weight](int a, int b) { return node_weight[a] > node_weight[b]; });
+            owners.resize(clique_params.max_cliques);
+        }
+        std::vector<std::vector<int>> cliques;
+        cliques.reserve(owners.size());
+        for (int i: owners) {
+            cliques.push_back(std::move(node_clique[i]));
+        }
+        return cliques;
     }
 
-    double
-    MaximalCliqueReg::evaluation_trans(std::vector<Corre_3DMatch> &Match,
-                                       pcl::PointCloud<pcl::PointXYZ>::Ptr &src_corr_pts,
-                                       pcl::PointCloud<pcl::PointXYZ>::Ptr &des_corr_pts, double weight_thresh,
-                                       Eigen::Matrix4d &trans, double metric_thresh) {
-
-        pcl::PointCloud<pcl::PointXYZ>::Ptr src_pts(new pcl::PointCloud<pcl::PointXYZ>);
-        pcl::PointCloud<pcl::PointXYZ>::Ptr des_pts(new pcl::PointCloud<pcl::PointXYZ>);
-        std::vector<double> weights;
-        for (auto &i: Match) {
-            if (i.score >= weight_thresh) {
-                src_pts->push_back(i.src);
-                des_pts->push_back(i.des);
-                weights.push_back(i.score);
+    double MaximalCliqueReg::evaluation_trans(const std::vector<int> &clique, const Eigen::Matrix3Xd &src_pts,
+                                              const Eigen::Matrix3Xd &des_pts, double weight_thresh,
+                                              Eigen::Matrix4d &trans, double metric_thresh) {
+        std::vector<int> selected;
+        for (int k: clique) {
+            if (correspondence[k].score >= weight_thresh) {
+                selected.push_back(k);
             }
         }
-        if (weights.size() < 3) {
+        if (selected.size() < 3) {
             return 0;
         }
-        Eigen::VectorXd weight_vec = Eigen::Map<Eigen::VectorXd, Eigen::Unaligned>(weights.data(), weights.size());
-        weights.clear();
-        weights.shrink_to_fit();
-        weight_vec /= weight_vec.maxCoeff();
-        weight_vec.setOnes(); // 2023.2.23
-        weight_SVD(src_pts, des_pts, weight_vec, 0, trans);
-        pcl::PointCloud<pcl::PointXYZ>::Ptr src_trans(new pcl::PointCloud<pcl::PointXYZ>);
-        pcl::transformPointCloud(*src_corr_pts, *src_trans, trans);
-        //Eigen::Matrix4f trans_f = trans.cast<float>();
-        //Eigen::Matrix3f R = trans_f.topLeftCorner(3, 3);
-        double score = 0.0;
-        int inlier = 0;
-        int corr_num = src_corr_pts->points.size();
-        for (int i = 0; i < corr_num; i++) {
-            double dist = Distance(src_trans->points[i], des_corr_pts->points[i]);
-            double w = 1;
-            if (dist < metric_thresh) {
-                inlier++;
-                score += (metric_thresh - dist) * w / metric_thresh;
-            }
+        Eigen::Matrix3Xd src_inliers(3, selected.size()), des_inliers(3, selected.size());
+        for (size_t i = 0; i < selected.size(); i++) {
+            src_inliers.col(i) = src_pts.col(selected[i]);
+            des_inliers.col(i) = des_pts.col(selected[i]);
         }
-        src_pts.reset(new pcl::PointCloud<pcl::PointXYZ>);
-        des_pts.reset(new pcl::PointCloud<pcl::PointXYZ>);
-        src_trans.reset(new pcl::PointCloud<pcl::PointXYZ>);
-        return score;
+        trans = gtsam::svdSE3(src_inliers, des_inliers);
+        // score all correspondences at once, only those closer than metric_thresh contribute
+        Eigen::ArrayXd dist = ((trans.block<3, 3>(0, 0) * src_pts).colwise() + trans.block<3, 1>(0, 3) -
+                               des_pts).colwise().norm().transpose().array();
+        return ((metric_thresh - dist) / metric_thresh).max(0.0).sum();
     }
 
     void MaximalCliqueReg::weight_SVD(pcl::PointCloud<pcl::PointXYZ>::Ptr &src_pts,
@@ -583,7 +692,10 @@ namespace mac_reg {
             t.score = 0;
             correspondence.push_back(t);
         }
-        MaximalCliqueReg mcr(true);
+        MaximalCliqueReg::CliqueSearchParams params = {3, g3reg::config.mac_max_branches,
+                                                       g3reg::config.mac_max_cliques,
+                                                       g3reg::config.mac_time_limit};
+        MaximalCliqueReg mcr(true, params);
         mcr.setCorrespondence(correspondence);
         Eigen::Matrix4d best_tf = mcr.run();
 
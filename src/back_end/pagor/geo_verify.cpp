@@ -198,4 +198,17 @@ Eigen::Matrix4d GeometryVerify(typename pcl::PointCloud<pcl::PointXYZ>::Ptr src_
         }
     }
     return best_pose;
-}
\ No newline at end of file
+}
+
+std::vector<Eigen::Matrix4d> ProjectToYaw(const std::vector<Eigen::Matrix4d> &candidates) {
+    std::vector<Eigen::Matrix4d> projected;
+    projected.reserve(candidates.size());
+    for (const auto &candidate: candidates) {
+        const double yaw = std::atan2(candidate(1, 0), candidate(0, 0));
+        Eigen::Matrix4d tf = Eigen::Matrix4d::Identity();
+        tf.block<3, 3>(0, 0) = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+        tf.block<3, 1>(0, 3) = candidate.block<3, 1>(0, 3);
+        projected.push_back(tf);
+    }
+    return projected;
+}
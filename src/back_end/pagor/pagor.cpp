@@ -7,6 +7,8 @@
 #include "back_end/pagor/pagor.h"
 #include "back_end/pagor/registration.h"
 #include "front_end/gem/downsample.h"
+#include "utils/trace.h"
+#include "utils/memory.h"
 #include "back_end/pagor/geo_verify.h"
 #include <chrono>
 
@@ -62,16 +64,29 @@ namespace pagor {
         // initialize the parameters
         teaser::RobustRegistrationSolver::Params params;
         params.noise_bound = config.vertex_info.noise_bound_vec[0];
+        params.inlier_selection_mode = config.mac_solver_mode;
         config.num_graphs = config.vertex_info.noise_bound_vec.size();
         assert(config.num_graphs <= config.vertex_info.noise_bound_vec.size());
-        pagor::PyramidRegistrationSolver solver(params, config.num_graphs);
-        solver.setQuadricFeatures(matcher.getSrcEllipsoids(), matcher.getTgtEllipsoids());
-        solver.solve(src_nodes, tgt_nodes, A);
-        teaser::RegistrationSolution solution = std::move(solver.getSolution());
+        std::vector<StageMemory> *memory = config.memory_stages ? &result.memory : nullptr;
+        teaser::RegistrationSolution solution;
+        {
+            // graphs, cliques and tf solving share the solver's buffers
+            MemoryScope solve_memory("pagor/solve", memory);
+            pagor::PyramidRegistrationSolver solver(params, config.num_graphs);
+            solver.setQuadricFeatures(matcher.getSrcEllipsoids(), matcher.getTgtEllipsoids());
+            solver.solve(src_nodes, tgt_nodes, A);
+            solution = std::move(solver.getSolution());
+        }
 
         robot_utils::TicToc verify_timer;
         Eigen::Matrix4d tf = Eigen::Matrix4d::Identity();
         bool verify_valid = true;
+        G3REG_TRACE_SCOPE("pagor/verify");
+        MemoryScope verify_memory("pagor/verify", memory);
+        if (config.yaw_only) {
+            // only 4-DoF candidates are scored, equal neighbours are skipped by the verification
+            solution.candidates = ProjectToYaw(solution.candidates);
+        }
         if (config.verify_mtd == "gem_based" && matcher.getSrcVoxels().size() > 0 &&
             matcher.getTgtVoxels().size() > 0) {
 //            std::tie(verify_valid, tf) = GeometryVerify(matcher.getSrcVoxels(), matcher.getTgtVoxels(), solution.candidates);
@@ -93,6 +108,8 @@ namespace pagor {
         result.clique_time = solution.clique_time;
         result.graph_time = solution.graph_time;
         result.tf_solver_time = solution.tf_solver_time;
+        result.level_times = solution.level_times;
+        result.clique_level_times = solution.clique_level_times;
         result.verify_time = verify_time;
         result.candidates = solution.candidates;
         countInliers(solution, tf, A, matcher, result);
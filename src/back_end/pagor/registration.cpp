@@ -10,6 +10,9 @@
 #include "robot_utils/tic_toc.h"
 #include "back_end/teaser/quatro.h"
 #include "robot_utils/algorithms.h"
+#include "utils/trace.h"
+#include <algorithm>
+#include <iterator>
 
 using namespace teaser;
 using namespace g3reg;
@@ -36,7 +39,14 @@ namespace pagor {
         // Update validity flag
         solution_.inliers = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Zero(num_graphs_, A_.rows());
         solution_.candidates.resize(num_graphs_);
-        for (int level = 0; level < num_graphs_; ++level) {
+        solution_.level_times.assign(num_graphs_, 0.0);
+        // teaser and quatro keep their state in the solver, so they stay level by level
+        bool batch = config.tf_batch && num_graphs_ > 1 && config.tf_solver != "teaser" &&
+                     config.tf_solver != "quatro" && !config.yaw_only;
+        if (batch) {
+            solveTransformsBatched(src, dst);
+        }
+        for (int level = 0; level < num_graphs_ && !batch; ++level) {
             const auto &max_clique = max_cliques_[level];
             bool same_clique =
                     level == 0 ? false : robot_utils::are_vectors_equal(max_cliques_[level - 1], max_cliques_[level]);
@@ -45,7 +55,11 @@ namespace pagor {
                 solution_.candidates[level] = solution_.candidates[level - 1];
                 continue;
             }
-            if (config.tf_solver == "gmm_tls") {
+            G3REG_TRACE_SCOPE("pagor/tf_solver", level);
+            robot_utils::TicToc level_timer;
+            if (config.yaw_only) {
+                solveTransformYaw(src, dst, max_clique, level);
+            } else if (config.tf_solver == "gmm_tls" || config.tf_solver == "gmm_tls_fused") {
                 solveTransformSVD(src, dst, max_clique, level);
                 solveTransformGMM(src_features_, dst_features_, max_clique, level, solution_.candidates[level]);
             } else if (config.tf_solver == "gnc") {
@@ -58,6 +72,7 @@ namespace pagor {
             } else {
                 throw std::runtime_error("Unknown tf solver type");
             }
+            solution_.level_times[level] = level_timer.toc();
         }
 
         std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
@@ -67,6 +82,156 @@ namespace pagor {
         return solution_;
     }
 
+    void PyramidRegistrationSolver::solveTransformsBatched(const std::vector<clique_solver::GraphVertex::Ptr> &src,
+                                                           const std::vector<clique_solver::GraphVertex::Ptr> &dst) {
+        const std::string &tf_solver = config.tf_solver;
+        if (tf_solver != "gmm_tls" && tf_solver != "gmm_tls_fused" && tf_solver != "gnc" && tf_solver != "svd") {
+            throw std::runtime_error("Unknown tf solver type");
+        }
+
+        // levels with equal cliques are solved once, source maps a level to the unique level it reuses
+        std::vector<int> unique_levels, source(num_graphs_);
+        for (int level = 0; level < num_graphs_; ++level) {
+            source[level] = unique_levels.size();
+            for (int j = 0; j < unique_levels.size(); ++j) {
+                if (robot_utils::are_vectors_equal(max_cliques_[unique_levels[j]], max_cliques_[level])) {
+                    source[level] = j;
+                    break;
+                }
+            }
+            if (source[level] == unique_levels.size()) {
+                unique_levels.push_back(level);
+            }
+        }
+        const int num_unique = unique_levels.size();
+
+        // the regularized quadric terms of every association in some clique, built once for all levels
+        std::vector<int> term_index(A_.rows(), -1);
+        std::vector<g3reg::GaussianGncTlsSE3::Term> terms;
+        std::vector<char> term_valid;
+        if (tf_solver == "gmm_tls_fused") {
+            for (int level: unique_levels) {
+                for (int i: max_cliques_[level]) {
+                    if (term_index[i] < 0) {
+                        term_index[i] = terms.size();
+                        terms.emplace_back();
+                        term_valid.push_back(gtsam::quadricTerm(src_features_[A_(i, 0)], dst_features_[A_(i, 1)],
+                                                                terms.back()));
+                    }
+                }
+            }
+        }
+
+        // warm-start tree: maximum spanning tree of the clique overlap (jaccard), rooted at the largest clique
+        std::vector<std::vector<int>> sorted_cliques(num_unique);
+        int root = 0;
+        for (int j = 0; j < num_unique; ++j) {
+            sorted_cliques[j] = max_cliques_[unique_levels[j]];
+            std::sort(sorted_cliques[j].begin(), sorted_cliques[j].end());
+            if (sorted_cliques[j].size() > sorted_cliques[root].size()) {
+                root = j;
+            }
+        }
+        auto overlap = [&sorted_cliques](int a, int b) {
+            const auto &ca = sorted_cliques[a], &cb = sorted_cliques[b];
+            std::vector<int> common;
+            std::set_intersection(ca.begin(), ca.end(), cb.begin(), cb.end(), std::back_inserter(common));
+            size_t num_union = ca.size() + cb.size() - common.size();
+            return num_union == 0 ? 0.0 : double(common.size()) / num_union;
+        };
+        std::vector<int> parent(num_unique, -1), depth(num_unique, 0);
+        std::vector<double> best(num_unique, -1);
+        std::vector<char> in_tree(num_unique, 0);
+        in_tree[root] = 1;
+        for (int j = 0; j < num_unique; ++j) {
+            if (j != root) {
+                best[j] = overlap(root, j);
+                parent[j] = root;
+            }
+        }
+        for (int added = 1; added < num_unique; ++added) {
+            int next = -1;
+            for (int j = 0; j < num_unique; ++j) {
+                if (!in_tree[j] && (next < 0 || best[j] > best[next])) {
+                    next = j;
+                }
+            }
+            in_tree[next] = 1;
+            depth[next] = depth[parent[next]] + 1;
+            for (int j = 0; j < num_unique; ++j) {
+                double o = in_tree[j] ? -1 : overlap(next, j);
+                if (!in_tree[j] && o > best[j]) {
+                    best[j] = o;
+                    parent[j] = next;
+                }
+            }
+        }
+
+        // one wave per tree depth, the levels of a wave only depend on the previous waves
+        std::vector<Eigen::Matrix4d> tfs(num_unique, Eigen::Matrix4d::Identity());
+        std::vector<char> valid(num_unique, 0);
+        const int max_depth = *std::max_element(depth.begin(), depth.end());
+        for (int d = 0; d <= max_depth; ++d) {
+            std::vector<int> wave;
+            for (int j = 0; j < num_unique; ++j) {
+                if (depth[j] == d) {
+                    wave.push_back(j);
+                }
+            }
+#pragma omp parallel for schedule(dynamic)
+            for (int k = 0; k < wave.size(); ++k) {
+                const int j = wave[k], level = unique_levels[j];
+                const std::vector<int> &max_clique = max_cliques_[level];
+                G3REG_TRACE_SCOPE("pagor/tf_solver", level);
+                robot_utils::TicToc level_timer;
+                if (max_clique.size() >= 3) {
+                    Eigen::Matrix3Xd clique_src(3, max_clique.size()), clique_dst(3, max_clique.size());
+                    for (size_t i = 0; i < max_clique.size(); ++i) {
+                        clique_src.col(i) = src.at(A_(max_clique[i], 0))->centroid;
+                        clique_dst.col(i) = dst.at(A_(max_clique[i], 1))->centroid;
+                    }
+                    // the svd solution is closed-form, the iterative solvers start from an overlapping parent
+                    bool warm_start = parent[j] >= 0 && best[j] > 0 && valid[parent[j]] && tf_solver != "svd";
+                    Eigen::Matrix4d init = warm_start ? tfs[parent[j]] : gtsam::svdSE3(clique_src, clique_dst);
+                    if (tf_solver == "svd") {
+                        tfs[j] = init;
+                    } else if (tf_solver == "gnc") {
+                        tfs[j] = gtsam::gncSE3(clique_src, clique_dst, init);
+                    } else if (tf_solver == "gmm_tls") {
+                        clique_solver::Association clique_A(max_clique.size(), 2);
+                        for (size_t i = 0; i < max_clique.size(); ++i) {
+                            clique_A.row(i) = A_.row(max_clique[i]);
+                        }
+                        tfs[j] = gtsam::gncQuadricsSE3(src_features_, dst_features_, clique_A, init);
+                    } else {
+                        g3reg::GaussianGncTlsSE3 gnc;
+                        gnc.reserve(max_clique.size());
+                        for (int i: max_clique) {
+                            if (term_valid[term_index[i]]) {
+                                gnc.add(terms[term_index[i]]);
+                            }
+                        }
+                        tfs[j] = gnc.solve(init);
+                    }
+                    valid[j] = 1;
+                }
+                solution_.level_times[level] = level_timer.toc();
+            }
+        }
+
+        for (int level = 0; level < num_graphs_; ++level) {
+            const int j = source[level];
+            solution_.candidates[level] = tfs[j];
+            if (valid[j]) {
+                for (int i: max_cliques_[level]) {
+                    solution_.inliers(level, i) = true;
+                }
+            }
+        }
+        // as in the level by level loop, the last level decides
+        solution_.valid = valid[source[num_graphs_ - 1]];
+    }
+
     void PyramidRegistrationSolver::solveTransformGMM(const std::vector<g3reg::QuadricFeature::Ptr> &v1,
                                                       const std::vector<g3reg::QuadricFeature::Ptr> &v2,
                                                       const std::vector<int> &max_clique, const int level,
@@ -79,7 +244,11 @@ namespace pagor {
 
         // Abort if max max_clique size <= 1
         if (max_clique.size() >= 3) {
-            solution_.candidates[level] = gtsam::gncQuadricsSE3(v1, v2, rotation_pruned_A, T_init);
+            if (config.tf_solver == "gmm_tls_fused") {
+                solution_.candidates[level] = gtsam::fusedGncQuadricsSE3(v1, v2, rotation_pruned_A, T_init);
+            } else {
+                solution_.candidates[level] = gtsam::gncQuadricsSE3(v1, v2, rotation_pruned_A, T_init);
+            }
             solution_.valid = true;
             for (size_t i = 0; i < max_clique.size(); ++i) {
                 solution_.inliers(level, max_clique[i]) = true;
@@ -143,6 +312,49 @@ namespace pagor {
         }
     }
 
+    void PyramidRegistrationSolver::solveTransformYaw(const std::vector<clique_solver::GraphVertex::Ptr> &src,
+                                                      const std::vector<clique_solver::GraphVertex::Ptr> &dst,
+                                                      const std::vector<int> &max_clique, const int level) {
+        if (max_clique.size() < 3) {
+            solution_.valid = false;
+            solution_.candidates[level] = Eigen::Matrix4d::Identity();
+            return;
+        }
+
+        Eigen::Matrix3Xd clique_src(3, max_clique.size());
+        Eigen::Matrix3Xd clique_dst(3, max_clique.size());
+        for (size_t i = 0; i < max_clique.size(); ++i) {
+            clique_src.col(i) = src.at(A_(max_clique[i], 0))->centroid;
+            clique_dst.col(i) = dst.at(A_(max_clique[i], 1))->centroid;
+        }
+
+        // yaw from the horizontal TIMs, which are free of the translation, with the TIM noise bound
+        Eigen::Matrix3Xd src_tims, dst_tims;
+        computeTIMs(clique_src, nullptr, params_.rotation_tim_graph, &src_tims, nullptr);
+        computeTIMs(clique_dst, nullptr, params_.rotation_tim_graph, &dst_tims, nullptr);
+        const double tim_bound = 2 * params_.noise_bound;
+        Eigen::Matrix2d yaw;
+        double cost;
+        yaw_workspace_.solveGncTls(src_tims.topRows<2>(), dst_tims.topRows<2>(), tim_bound * tim_bound,
+                                   params_.rotation_gnc_factor, params_.rotation_cost_threshold,
+                                   params_.rotation_max_iterations, &yaw, &cost);
+        solution_.rotation = Eigen::Matrix3d::Identity();
+        solution_.rotation.topLeftCorner<2, 2>() = yaw;
+
+        // per-axis TLS translation, z is left to it entirely
+        solveForTranslation(solution_.rotation * clique_src, clique_dst);
+
+        solution_.valid = true;
+        solution_.candidates[level] = Eigen::Matrix4d::Identity();
+        solution_.candidates[level].block<3, 3>(0, 0) = solution_.rotation;
+        solution_.candidates[level].block<3, 1>(0, 3) = solution_.translation;
+        for (size_t i = 0; i < max_clique.size(); ++i) {
+            if (translation_inliers_mask_(0, i)) {
+                solution_.inliers(level, max_clique[i]) = true;
+            }
+        }
+    }
+
     std::vector<int>
     PyramidRegistrationSolver::solveTransformTeaser(const std::vector<clique_solver::GraphVertex::Ptr> &src,
                                                     const std::vector<clique_solver::GraphVertex::Ptr> &dst,
@@ -155,53 +367,19 @@ namespace pagor {
             return max_clique;
         }
 
-        // TIMs used for rotation estimation
+        // TIMs used for rotation estimation, only between the max clique inliers
+        TEASER_DEBUG_INFO_MSG("Using " << (params_.rotation_tim_graph == INLIER_GRAPH_FORMULATION::CHAIN ?
+                                           "chain" : "complete") << " graph for GNC rotation.");
+        Eigen::Matrix3Xd src_inliers(3, max_clique.size());
+        Eigen::Matrix3Xd dst_inliers(3, max_clique.size());
+        for (size_t i = 0; i < max_clique.size(); ++i) {
+            src_inliers.col(i) = src.at(A_(max_clique[i], 0))->centroid;
+            dst_inliers.col(i) = dst.at(A_(max_clique[i], 1))->centroid;
+        }
         Eigen::Matrix3Xd pruned_src_tims;
         Eigen::Matrix3Xd pruned_dst_tims;
-        // TIM maps for rotation estimation
-        Eigen::Matrix<int, 2, Eigen::Dynamic> src_tims_map_rotation;
-        Eigen::Matrix<int, 2, Eigen::Dynamic> dst_tims_map_rotation;
-
-        // Calculate new measurements & TIMs based on max clique inliers
-        if (params_.rotation_tim_graph == INLIER_GRAPH_FORMULATION::CHAIN) {
-            // chain graph 知道正确的匹配关系（可能还含有一些外点）后，用chain graph来构造TIMS来估计R
-            TEASER_DEBUG_INFO_MSG("Using chain graph for GNC rotation.");
-            pruned_src_tims.resize(3, max_clique.size());
-            pruned_dst_tims.resize(3, max_clique.size());
-            src_tims_map_rotation.resize(2, max_clique.size());
-            dst_tims_map_rotation.resize(2, max_clique.size());
-            for (size_t i = 0; i < max_clique.size(); ++i) {
-                const auto &root = max_clique[i];
-                int leaf;
-                if (i != max_clique.size() - 1) {
-                    leaf = max_clique[i + 1];
-                } else {
-                    leaf = max_clique[0];
-                }
-
-                pruned_src_tims.col(i) = src.at(A_(leaf, 0))->centroid - src.at(A_(root, 0))->centroid;
-                pruned_dst_tims.col(i) = dst.at(A_(leaf, 1))->centroid - dst.at(A_(root, 1))->centroid;
-
-                // populate the TIMs map
-                dst_tims_map_rotation(0, i) = leaf;
-                dst_tims_map_rotation(1, i) = root;
-                src_tims_map_rotation(0, i) = leaf;
-                src_tims_map_rotation(1, i) = root;
-            }
-        } else {
-            // complete graph
-            TEASER_DEBUG_INFO_MSG("Using complete graph for GNC rotation.");
-            // select the inlier measurements with max clique
-            Eigen::Matrix3Xd src_inliers(3, max_clique.size());
-            Eigen::Matrix3Xd dst_inliers(3, max_clique.size());
-            for (size_t i = 0; i < max_clique.size(); ++i) {
-                src_inliers.col(i) = src.at(A_(max_clique[i], 0))->centroid;
-                dst_inliers.col(i) = dst.at(A_(max_clique[i], 1))->centroid;
-            }
-            // construct the TIMs
-            pruned_dst_tims = RobustRegistrationSolver::computeTIMs(dst_inliers, &dst_tims_map_rotation);
-            pruned_src_tims = RobustRegistrationSolver::computeTIMs(src_inliers, &src_tims_map_rotation);
-        }
+        computeTIMs(src_inliers, nullptr, params_.rotation_tim_graph, &pruned_src_tims, nullptr);
+        computeTIMs(dst_inliers, nullptr, params_.rotation_tim_graph, &pruned_dst_tims, nullptr);
 
         // Remove scaling for rotation estimation
         pruned_dst_tims *= (1 / solution_.scale);
@@ -310,6 +488,7 @@ namespace pagor {
             params_.inlier_selection_mode = INLIER_SELECTION_MODE::PMC_HEU;
         }
         // Calculate Maximum Clique
+        solution_.clique_level_times.assign(num_graphs_, 0.0);
         if (params_.inlier_selection_mode != INLIER_SELECTION_MODE::NONE) {
             if (params_.inlier_selection_mode == INLIER_SELECTION_MODE::PMC_EXACT) {
                 clique_solver::MaxCliqueSolver::Params clique_params;
@@ -318,9 +497,37 @@ namespace pagor {
                 clique_params.kcore_heuristic_threshold = params_.kcore_heuristic_threshold;
                 int prune_level = 0;
                 for (int level = 0; level < num_graphs_; ++level) {
+                    G3REG_TRACE_SCOPE("pagor/max_clique", level);
+                    robot_utils::TicToc level_timer;
                     clique_solver::MaxCliqueSolver mac_solver(clique_params);
-                    max_cliques_[level] = mac_solver.findMaxClique(inlier_graphs_[level], prune_level);
+                    inlier_graphs_[level].toCSR(&csr_offsets_, &csr_neighbors_);
+                    max_cliques_[level] = mac_solver.findMaxClique(csr_offsets_, csr_neighbors_, prune_level);
                     prune_level = config.grad_pmc ? max_cliques_[level].size() : 0;
+                    solution_.clique_level_times[level] = level_timer.toc();
+                }
+            } else if (params_.inlier_selection_mode == INLIER_SELECTION_MODE::CLIPPER) {
+                // the levels are nested, the dense clique of a level is a clique of the next one and starts it
+                clipper::Params clipper_params;
+                clipper_params.use_csr = true;
+                clipper::CLIPPER clipper(clipper_params);
+                Eigen::VectorXd u0;
+                for (int level = 0; level < num_graphs_; ++level) {
+                    G3REG_TRACE_SCOPE("pagor/max_clique", level);
+                    robot_utils::TicToc level_timer;
+                    clipper.setGraph(inlier_graphs_[level]);
+                    clipper.solve(u0);
+                    max_cliques_[level] = clipper.getSolution().nodes;
+                    u0 = clipper.getSolution().u;
+                    solution_.clique_level_times[level] = level_timer.toc();
+                }
+            } else if (params_.inlier_selection_mode == INLIER_SELECTION_MODE::PYCLIPPER) {
+                G3REG_TRACE_SCOPE("pagor/max_clique");
+                clipper::Params clipper_params;
+                clipper_params.use_csr = true;
+                clipper::PyCLIPPER clipper(inlier_graphs_, clipper_params);
+                clipper.solve();
+                for (int level = 0; level < num_graphs_; ++level) {
+                    max_cliques_[level] = clipper.getSolutions()[level].nodes;
                 }
             }
             for (int level = 0; level < num_graphs_; ++level) {
@@ -342,6 +549,7 @@ namespace pagor {
 
     void PyramidRegistrationSolver::buildGraphs(const std::vector<clique_solver::GraphVertex::Ptr> &v1,
                                                 const std::vector<clique_solver::GraphVertex::Ptr> &v2) {
+        G3REG_TRACE_SCOPE("pagor/build_graphs");
         num_corr_ = A_.rows();
         int num_tims = num_corr_ * (num_corr_ - 1) / 2;
 
@@ -349,12 +557,19 @@ namespace pagor {
             inlier_graphs_[level].populateVertices(num_corr_);
         }
 
+        // under a yaw-only motion the z components of the TIMs must agree as well as their lengths
+        const bool yaw_only = config.yaw_only;
         robot_utils::TicToc t_graph;
-#pragma omp parallel for default(none) shared(num_corr_, num_tims, v1, v2, inlier_graphs_, A_)
+#pragma omp parallel for default(none) shared(num_corr_, num_tims, v1, v2, inlier_graphs_, A_, yaw_only)
         for (size_t k = 0; k < num_tims; ++k) {
             size_t i, j;
             std::tie(i, j) = clique_solver::k2ij(k, num_corr_);
-            const auto &weights = (*v1[A_(j, 0)] - *v1[A_(i, 0)])->consistent(*(*v2[A_(j, 1)] - *v2[A_(i, 1)]));
+            const auto &src_tim = *v1[A_(j, 0)] - *v1[A_(i, 0)];
+            const auto &dst_tim = *v2[A_(j, 1)] - *v2[A_(i, 1)];
+            Eigen::VectorXd weights = src_tim->consistent(*dst_tim);
+            if (yaw_only) {
+                weights = weights.cwiseMin(src_tim->consistentHeight(*dst_tim));
+            }
             for (int level = 0; level < num_graphs_; ++level) {
                 if (weights(level) > 0.0) {
 #pragma omp critical
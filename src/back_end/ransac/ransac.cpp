@@ -6,6 +6,9 @@
 #include "back_end/ransac/ransac.h"
 #include <vector>
 #include <random>
+#include <numeric>
+#include <algorithm>
+#include <omp.h>
 #include <Eigen/Geometry>
 #include "utils/opt_utils.h"
 
@@ -15,6 +18,72 @@ using namespace g3reg;
 
 namespace ransac {
 
+    static bool sample_hypothesis(const std::vector<Eigen::Vector3d> &src_points,
+                                  const std::vector<Eigen::Vector3d> &tgt_points,
+                                  const Eigen::MatrixX2i &associations, std::mt19937 &rng,
+                                  Eigen::Matrix4d &transform) {
+        int num_points = associations.rows();
+        std::uniform_int_distribution<int> dist(0, num_points - 1);
+        int i = dist(rng), j = dist(rng), l = dist(
+                rng), src_i_idx, src_j_idx, src_k_idx, tgt_i_idx, tgt_j_idx, tgt_k_idx;
+        src_i_idx = associations(i, 0), src_j_idx = associations(j, 0), src_k_idx = associations(l, 0);
+        tgt_i_idx = associations(i, 1), tgt_j_idx = associations(j, 1), tgt_k_idx = associations(l, 1);
+        // Check if there are overlaps in the indices
+        if (src_i_idx == src_j_idx || src_i_idx == src_k_idx || src_j_idx == src_k_idx ||
+            tgt_i_idx == tgt_j_idx || tgt_i_idx == tgt_k_idx || tgt_j_idx == tgt_k_idx) {
+            return false;
+        }
+
+        const auto &src_i = src_points[associations(i, 0)];
+        const auto &tgt_i = tgt_points[associations(i, 1)];
+
+        const auto &src_j = src_points[associations(j, 0)];
+        const auto &tgt_j = tgt_points[associations(j, 1)];
+
+        const auto &src_k = src_points[associations(l, 0)];
+        const auto &tgt_k = tgt_points[associations(l, 1)];
+
+        float src_ij_dist = (src_i - src_j).norm(), src_ik_dist = (src_i - src_k).norm(), src_jk_dist = (src_j -
+                                                                                                         src_k).norm();
+        float tgt_ij_dist = (tgt_i - tgt_j).norm(), tgt_ik_dist = (tgt_i - tgt_k).norm(), tgt_jk_dist = (tgt_j -
+                                                                                                         tgt_k).norm();
+        float scale = 0.95;
+        // Check if the distances between the points are within translation_resolution
+        if (src_ij_dist < tgt_ij_dist * scale || tgt_ij_dist < src_ij_dist * scale ||
+            src_ik_dist < tgt_ik_dist * scale || tgt_ik_dist < src_ik_dist * scale ||
+            src_jk_dist < tgt_jk_dist * scale || tgt_jk_dist < src_jk_dist * scale) {
+            return false;
+        }
+        Eigen::Matrix3Xd P(3, 3), Q(3, 3);
+        P.col(0) = src_i;
+        P.col(1) = src_j;
+        P.col(2) = src_k;
+        Q.col(0) = tgt_i;
+        Q.col(1) = tgt_j;
+        Q.col(2) = tgt_k;
+
+        transform = gtsam::svdSE3(P, Q);
+        return true;
+    }
+
+    // count the inliers among associations order[begin, end)
+    static int count_inliers(const Eigen::Matrix4d &transform, const std::vector<Eigen::Vector3d> &src_points,
+                             const std::vector<Eigen::Vector3d> &tgt_points, const Eigen::MatrixX2i &associations,
+                             const std::vector<int> &order, int begin, int end, double inlier_threshold) {
+        const Eigen::Matrix3d R = transform.block<3, 3>(0, 0);
+        const Eigen::Vector3d t = transform.block<3, 1>(0, 3);
+        const double threshold_sq = inlier_threshold * inlier_threshold;
+        int inliers = 0;
+        for (int k = begin; k < end; ++k) {
+            int i = order[k];
+            if ((R * src_points[associations(i, 0)] + t - tgt_points[associations(i, 1)]).squaredNorm() <
+                threshold_sq) {
+                ++inliers;
+            }
+        }
+        return inliers;
+    }
+
     Eigen::Matrix4d
     ransac_registration(const std::vector<Eigen::Vector3d> &src_points, const std::vector<Eigen::Vector3d> &tgt_points,
                         const Eigen::MatrixX2i &associations, RansacParams params) {
@@ -22,52 +91,16 @@ namespace ransac {
         int best_inliers = -1;
         Eigen::Matrix4d best_transform = Eigen::Matrix4d::Identity();
         std::mt19937 rng(std::random_device{}());
-        std::uniform_int_distribution<int> dist(0, num_points - 1);
 
         int inliers_to_end = params.inliers_to_end * num_points;
 #pragma omp parallel for
         for (int iter = 0; iter < params.max_iterations; ++iter) {
             if (best_inliers >= inliers_to_end) continue; // End early if enough inliers have been found
 
-            int i = dist(rng), j = dist(rng), l = dist(
-                    rng), src_i_idx, src_j_idx, src_k_idx, tgt_i_idx, tgt_j_idx, tgt_k_idx;
-            src_i_idx = associations(i, 0), src_j_idx = associations(j, 0), src_k_idx = associations(l, 0);
-            tgt_i_idx = associations(i, 1), tgt_j_idx = associations(j, 1), tgt_k_idx = associations(l, 1);
-            // Check if there are overlaps in the indices
-            if (src_i_idx == src_j_idx || src_i_idx == src_k_idx || src_j_idx == src_k_idx ||
-                tgt_i_idx == tgt_j_idx || tgt_i_idx == tgt_k_idx || tgt_j_idx == tgt_k_idx) {
+            Eigen::Matrix4d transform_candidate;
+            if (!sample_hypothesis(src_points, tgt_points, associations, rng, transform_candidate)) {
                 continue;
             }
-
-            const auto &src_i = src_points[associations(i, 0)];
-            const auto &tgt_i = tgt_points[associations(i, 1)];
-
-            const auto &src_j = src_points[associations(j, 0)];
-            const auto &tgt_j = tgt_points[associations(j, 1)];
-
-            const auto &src_k = src_points[associations(l, 0)];
-            const auto &tgt_k = tgt_points[associations(l, 1)];
-
-            float src_ij_dist = (src_i - src_j).norm(), src_ik_dist = (src_i - src_k).norm(), src_jk_dist = (src_j -
-                                                                                                             src_k).norm();
-            float tgt_ij_dist = (tgt_i - tgt_j).norm(), tgt_ik_dist = (tgt_i - tgt_k).norm(), tgt_jk_dist = (tgt_j -
-                                                                                                             tgt_k).norm();
-            float scale = 0.95;
-            // Check if the distances between the points are within translation_resolution
-            if (src_ij_dist < tgt_ij_dist * scale || tgt_ij_dist < src_ij_dist * scale ||
-                src_ik_dist < tgt_ik_dist * scale || tgt_ik_dist < src_ik_dist * scale ||
-                src_jk_dist < tgt_jk_dist * scale || tgt_jk_dist < src_jk_dist * scale) {
-                continue;
-            }
-            Eigen::Matrix3Xd P(3, 3), Q(3, 3);
-            P.col(0) = src_i;
-            P.col(1) = src_j;
-            P.col(2) = src_k;
-            Q.col(0) = tgt_i;
-            Q.col(1) = tgt_j;
-            Q.col(2) = tgt_k;
-
-            Eigen::Matrix4d transform_candidate = gtsam::svdSE3(P, Q);
             int inliers = 0;
             for (int i = 0; i < num_points; ++i) {
                 Eigen::Vector3d src = src_points[associations(i, 0)];
@@ -89,6 +122,83 @@ namespace ransac {
         return best_transform;
     }
 
+    Eigen::Matrix4d
+    preemptive_ransac_registration(const std::vector<Eigen::Vector3d> &src_points,
+                                   const std::vector<Eigen::Vector3d> &tgt_points,
+                                   const Eigen::MatrixX2i &associations, RansacParams params) {
+        int num_points = associations.rows();
+        int best_inliers = -1;
+        Eigen::Matrix4d best_transform = Eigen::Matrix4d::Identity();
+        if (num_points < 3) {
+            return best_transform;
+        }
+        std::mt19937 rng(std::random_device{}());
+        const int num_hypotheses = std::max(1, params.preemptive_hypotheses);
+        const int block_size = std::max(1, params.preemptive_block);
+        int inliers_to_end = params.inliers_to_end * num_points;
+
+        // a single random permutation makes every scoring block an unbiased subset of the associations
+        std::vector<int> order(num_points);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        std::vector<std::mt19937> thread_rngs;
+        for (int t = 0; t < omp_get_max_threads(); ++t) {
+            thread_rngs.emplace_back(rng());
+        }
+        std::vector<Eigen::Matrix4d> hypotheses(num_hypotheses);
+        std::vector<char> hypothesis_valid(num_hypotheses);
+        std::vector<int> scores(num_hypotheses);
+        std::vector<int> active;
+        active.reserve(num_hypotheses);
+        auto by_score = [&scores](int a, int b) { return scores[a] > scores[b]; };
+
+        int num_samples = 0;
+        while (num_samples < params.max_iterations && best_inliers < inliers_to_end) {
+            int round_size = std::min(num_hypotheses, params.max_iterations - num_samples);
+            num_samples += round_size;
+#pragma omp parallel for
+            for (int h = 0; h < round_size; ++h) {
+                hypothesis_valid[h] = sample_hypothesis(src_points, tgt_points, associations,
+                                                        thread_rngs[omp_get_thread_num()], hypotheses[h]);
+                scores[h] = 0;
+            }
+            active.clear();
+            for (int h = 0; h < round_size; ++h) {
+                if (hypothesis_valid[h]) {
+                    active.push_back(h);
+                }
+            }
+            if (active.empty()) {
+                continue;
+            }
+
+            // score the survivors on the next block, then keep the better half
+            int scored = 0;
+            while (active.size() > 1 && scored < num_points) {
+                int block_end = std::min(scored + block_size, num_points);
+#pragma omp parallel for
+                for (int a = 0; a < int(active.size()); ++a) {
+                    scores[active[a]] += count_inliers(hypotheses[active[a]], src_points, tgt_points, associations,
+                                                       order, scored, block_end, params.inlier_threshold);
+                }
+                scored = block_end;
+                size_t keep = std::max<size_t>(1, active.size() / 2);
+                std::nth_element(active.begin(), active.begin() + keep - 1, active.end(), by_score);
+                active.resize(keep);
+            }
+
+            int winner = *std::min_element(active.begin(), active.end(), by_score);
+            int inliers = scores[winner] + count_inliers(hypotheses[winner], src_points, tgt_points, associations,
+                                                         order, scored, num_points, params.inlier_threshold);
+            if (inliers > best_inliers && inliers >= params.min_inliers) {
+                best_inliers = inliers;
+                best_transform = hypotheses[winner];
+            }
+        }
+        return best_transform;
+    }
+
 
     void solve(const std::vector<GraphVertex::Ptr> &src_nodes, const std::vector<GraphVertex::Ptr> &tgt_nodes,
                const Association &A, FRGresult &result) {
@@ -99,6 +209,9 @@ namespace ransac {
         params.min_inliers = 3;
         params.inlier_threshold = config.ransac_inlier_threshold;
         params.inliers_to_end = config.ransac_inliers_to_end;
+        params.scoring = config.ransac_scoring;
+        params.preemptive_hypotheses = config.ransac_preemptive_hypotheses;
+        params.preemptive_block = config.ransac_preemptive_block;
 
         std::vector<Eigen::Vector3d> src_points, tgt_points;
         for (int i = 0; i < src_nodes.size(); ++i) {
@@ -109,7 +222,12 @@ namespace ransac {
         }
 
         robot_utils::TicToc timer;
-        Eigen::Matrix4d tf = ransac_registration(src_points, tgt_points, A, params);
+        Eigen::Matrix4d tf;
+        if (params.scoring == "preemptive") {
+            tf = preemptive_ransac_registration(src_points, tgt_points, A, params);
+        } else {
+            tf = ransac_registration(src_points, tgt_points, A, params);
+        }
         result.tf_solver_time = timer.toc();
         result.tf = tf;
     }
@@ -11,6 +11,8 @@
 #include "back_end/pagor/pagor.h"
 #include "back_end/ransac/ransac.h"
 #include "back_end/mac3d/mac_reg.h"
+#include "utils/trace.h"
+#include "utils/memory.h"
 
 using namespace std;
 using namespace clique_solver;
@@ -20,32 +22,42 @@ namespace g3reg { //fast and robust global registration
     FRGresult GlobalRegistration(const pcl::PointCloud<pcl::PointXYZ>::Ptr &src_cloud,
                                  const pcl::PointCloud<pcl::PointXYZ>::Ptr &tgt_cloud,
                                  std::tuple<int, int, int> pair_info) {
+        G3REG_TRACE_SCOPE("registration");
 
         FRGresult result;
+        std::vector<StageMemory> *memory = config.memory_stages ? &result.memory : nullptr;
         std::vector<GraphVertex::Ptr> src_nodes, tgt_nodes;
         Association A;
         g3reg::EllipsoidMatcher matcher(src_cloud, tgt_cloud);
         robot_utils::TicToc front_end_timer, timer;
-        if (config.front_end == "gem") {
-            A = std::move(matcher.matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes));
-        } else if (config.front_end == "fpfh") {
-            A = std::move(fpfh::matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes));
-        } else if (config.front_end == "iss_fpfh") {
-            A = std::move(iss_fpfh::matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes));
-        } else if (config.front_end == "fcgf") {
-            A = std::move(fcgf::matching(pair_info, src_nodes, tgt_nodes));
-        } else if (config.front_end == "none") {
+        {
+            G3REG_TRACE_SCOPE("front_end");
+            MemoryScope front_end_memory("front_end", memory);
+            if (config.front_end == "gem") {
+                A = std::move(matcher.matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes));
+            } else if (config.front_end == "fpfh") {
+                A = std::move(fpfh::matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes));
+            } else if (config.front_end == "iss_fpfh") {
+                A = std::move(iss_fpfh::matching(src_cloud, tgt_cloud, src_nodes, tgt_nodes));
+            } else if (config.front_end == "fcgf") {
+                A = std::move(fcgf::matching(pair_info, src_nodes, tgt_nodes));
+            } else if (config.front_end == "none") {
+            }
         }
         result.feature_time = front_end_timer.toc();
 
-        if (config.back_end == "pagor") {
-            pagor::solve(src_nodes, tgt_nodes, A, matcher, result);
-        } else if (config.back_end == "ransac") {
-            ransac::solve(src_nodes, tgt_nodes, A, result);
-        } else if (config.back_end == "3dmac") {
-            mac_reg::solve(src_nodes, tgt_nodes, A, result);
-        } else {
-            throw std::runtime_error("Unknown back end method");
+        {
+            G3REG_TRACE_SCOPE("back_end");
+            MemoryScope back_end_memory("back_end", memory);
+            if (config.back_end == "pagor") {
+                pagor::solve(src_nodes, tgt_nodes, A, matcher, result);
+            } else if (config.back_end == "ransac") {
+                ransac::solve(src_nodes, tgt_nodes, A, result);
+            } else if (config.back_end == "3dmac") {
+                mac_reg::solve(src_nodes, tgt_nodes, A, result);
+            } else {
+                throw std::runtime_error("Unknown back end method");
+            }
         }
 
         result.total_time = timer.toc();
@@ -53,7 +65,7 @@ namespace g3reg { //fast and robust global registration
     }
 
 
-    pcl::PointCloud<pcl::PointXYZ>::Ptr eigenToPCL(const Eigen::MatrixX3d &eigen_matrix) {
+    pcl::PointCloud<pcl::PointXYZ>::Ptr eigenToPCL(const PointsRef &eigen_matrix) {
         // 创建一个新的点云
         pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
 
@@ -76,19 +88,28 @@ namespace g3reg { //fast and robust global registration
         return cloud;
     }
 
-    FRGresult SolveFromCorresp(const Eigen::MatrixX3d &src_corresp,
-                               const Eigen::MatrixX3d &tgt_corresp,
-                               const Eigen::MatrixX3d &src_cloud,
-                               const Eigen::MatrixX3d &tgt_cloud,
+    FRGresult SolveFromCorresp(const PointsRef &src_corresp,
+                               const PointsRef &tgt_corresp,
+                               const PointsRef &src_cloud,
+                               const PointsRef &tgt_cloud,
                                const Config &config_custom) {
+        G3REG_TRACE_SCOPE("registration");
 
         assert(src_corresp.rows() == tgt_corresp.rows());
 
         config = config_custom;
 
         FRGresult result;
+        std::vector<StageMemory> *memory = config.memory_stages ? &result.memory : nullptr;
         std::vector<GraphVertex::Ptr> src_nodes, tgt_nodes;
-        g3reg::EllipsoidMatcher matcher(eigenToPCL(src_cloud), eigenToPCL(tgt_cloud));
+        // only the pagor back end verifies on the dense clouds, the others never read them
+        pcl::PointCloud<pcl::PointXYZ>::Ptr src_pc(new pcl::PointCloud<pcl::PointXYZ>);
+        pcl::PointCloud<pcl::PointXYZ>::Ptr tgt_pc(new pcl::PointCloud<pcl::PointXYZ>);
+        if (config.back_end == "pagor") {
+            src_pc = eigenToPCL(src_cloud);
+            tgt_pc = eigenToPCL(tgt_cloud);
+        }
+        g3reg::EllipsoidMatcher matcher(src_pc, tgt_pc);
         robot_utils::TicToc front_end_timer, timer;
 
         int64_t num_corresp = src_corresp.rows();
@@ -99,21 +120,25 @@ namespace g3reg { //fast and robust global registration
         for (int i = 0; i < num_corresp; i++) {
             A(i, 0) = i;
             A(i, 1) = i;
-            const Eigen::Vector3d &center = src_corresp.row(i);
+            const Eigen::Vector3d center = src_corresp.row(i).transpose();
             src_nodes.push_back(clique_solver::create_vertex(center, config.vertex_info));
-            const Eigen::Vector3d &center_tgt = tgt_corresp.row(i);
+            const Eigen::Vector3d center_tgt = tgt_corresp.row(i).transpose();
             tgt_nodes.push_back(clique_solver::create_vertex(center_tgt, config.vertex_info));
         }
         result.feature_time = front_end_timer.toc();
 
-        if (config.back_end == "pagor") {
-            pagor::solve(src_nodes, tgt_nodes, A, matcher, result);
-        } else if (config.back_end == "ransac") {
-            ransac::solve(src_nodes, tgt_nodes, A, result);
-        } else if (config.back_end == "3dmac") {
-            mac_reg::solve(src_nodes, tgt_nodes, A, result);
-        } else {
-            throw std::runtime_error("Unknown back end method");
+        {
+            G3REG_TRACE_SCOPE("back_end");
+            MemoryScope back_end_memory("back_end", memory);
+            if (config.back_end == "pagor") {
+                pagor::solve(src_nodes, tgt_nodes, A, matcher, result);
+            } else if (config.back_end == "ransac") {
+                ransac::solve(src_nodes, tgt_nodes, A, result);
+            } else if (config.back_end == "3dmac") {
+                mac_reg::solve(src_nodes, tgt_nodes, A, result);
+            } else {
+                throw std::runtime_error("Unknown back end method");
+            }
         }
 
         result.total_time = timer.toc();
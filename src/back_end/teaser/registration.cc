@@ -9,6 +9,8 @@
 #include "back_end/teaser/registration.h"
 
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 #include <functional>
 #include <limits>
 #include <iterator>
@@ -203,6 +205,116 @@ void teaser::ScalarTLSEstimator::estimate_tiled(const Eigen::RowVectorXd &X,
     }
 }
 
+void teaser::ScalarTLSEstimator::sortBounds(size_t n) {
+    // below ~1000 bounds the six histogram passes cost more than the comparison sort
+    if (n < 1024) {
+        std::sort(bounds_.begin(), bounds_.begin() + n,
+                  [](const Bound &a, const Bound &b) { return a.key < b.key; });
+        return;
+    }
+    // LSD radix sort on 11-bit digits, the histograms of all digits come from one pass
+    constexpr int kBits = 11, kPasses = 6, kBuckets = 1 << kBits;
+    histograms_.assign(kPasses * kBuckets, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (int pass = 0; pass < kPasses; ++pass) {
+            histograms_[pass * kBuckets + ((bounds_[i].key >> (pass * kBits)) & (kBuckets - 1))]++;
+        }
+    }
+    bounds_scratch_.resize(bounds_.size());
+    for (int pass = 0; pass < kPasses; ++pass) {
+        size_t *count = histograms_.data() + pass * kBuckets;
+        const int shift = pass * kBits;
+        // all keys share this digit, e.g. the sign and exponent of bounds in a narrow range
+        if (count[(bounds_[0].key >> shift) & (kBuckets - 1)] == n) {
+            continue;
+        }
+        size_t offset = 0;
+        for (int d = 0; d < kBuckets; ++d) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            bounds_scratch_[count[(bounds_[i].key >> shift) & (kBuckets - 1)]++] = bounds_[i];
+        }
+        bounds_.swap(bounds_scratch_);
+    }
+}
+
+void teaser::ScalarTLSEstimator::estimate_radix(const Eigen::RowVectorXd &X,
+                                                const Eigen::RowVectorXd &ranges, double *estimate,
+                                                Eigen::Matrix<bool, 1, Eigen::Dynamic> *inliers) {
+    bool dimension_inconsistent = (X.rows() != ranges.rows()) || (X.cols() != ranges.cols());
+    if (inliers) {
+        dimension_inconsistent |= ((inliers->rows() != 1) || (inliers->cols() != ranges.cols()));
+    }
+    bool only_one_element = (X.rows() == 1) && (X.cols() == 1);
+    assert(!dimension_inconsistent);
+    assert(!only_one_element);
+
+    const size_t N = X.cols(), nr_centers = 2 * N;
+    // flip the sign bit of positive doubles and all bits of negative ones, the keys then order as the values
+    auto key = [](double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+    };
+    bounds_.resize(nr_centers);
+    for (size_t i = 0; i < N; ++i) {
+        bounds_[2 * i] = {key(X(i) - ranges(i)), int64_t(i) + 1};
+        bounds_[2 * i + 1] = {key(X(i) + ranges(i)), -int64_t(i) - 1};
+    }
+    sortBounds(nr_centers);
+
+    for (auto *buffer: {&x_hat_, &cardinal_, &sum_xi_, &sum_xi_square_, &ranges_sum_, &x_cost_}) {
+        buffer->resize(nr_centers);
+    }
+    weights_.resize(N);
+    Eigen::Map<Eigen::ArrayXd> weights(weights_.data(), N);
+    weights = ranges.array().square().inverse();
+
+    // prefix sums in bound order, the same operations as estimate()
+    double ranges_inverse_sum = ranges.sum();
+    double dot_X_weights = 0;
+    double dot_weights_consensus = 0;
+    int consensus_set_cardinal = 0;
+    double sum_xi = 0;
+    double sum_xi_square = 0;
+    for (size_t i = 0; i < nr_centers; ++i) {
+        const int64_t id = bounds_[i].id;
+        const size_t idx = (id > 0 ? id : -id) - 1;
+        const int epsilon = id > 0 ? 1 : -1;
+        const double x = X(idx);
+        consensus_set_cardinal += epsilon;
+        dot_weights_consensus += epsilon * weights_[idx];
+        dot_X_weights += epsilon * weights_[idx] * x;
+        ranges_inverse_sum -= epsilon * ranges(idx);
+        sum_xi += epsilon * x;
+        sum_xi_square += epsilon * x * x;
+        x_hat_[i] = dot_X_weights / dot_weights_consensus;
+        cardinal_[i] = consensus_set_cardinal;
+        sum_xi_[i] = sum_xi;
+        sum_xi_square_[i] = sum_xi_square;
+        ranges_sum_[i] = ranges_inverse_sum;
+    }
+    typedef Eigen::Map<const Eigen::ArrayXd> ConstMap;
+    ConstMap x_hat(x_hat_.data(), nr_centers), cardinal(cardinal_.data(), nr_centers);
+    ConstMap sum_xi_map(sum_xi_.data(), nr_centers), sum_xi_square_map(sum_xi_square_.data(), nr_centers);
+    ConstMap ranges_sum(ranges_sum_.data(), nr_centers);
+    Eigen::Map<Eigen::ArrayXd> x_cost(x_cost_.data(), nr_centers);
+    x_cost = cardinal * x_hat * x_hat + sum_xi_square_map - 2 * sum_xi_map * x_hat + ranges_sum;
+
+    Eigen::Index min_idx;
+    x_cost.minCoeff(&min_idx);
+    double estimate_temp = x_hat_[min_idx];
+    if (estimate) {
+        *estimate = estimate_temp;
+    }
+    if (inliers) {
+        *inliers = (X.array() - estimate_temp).array().abs() <= ranges.array();
+    }
+}
+
 void teaser::FastGlobalRegistrationSolver::solveForRotation(
         const Eigen::Matrix<double, 3, Eigen::Dynamic> &src,
         const Eigen::Matrix<double, 3, Eigen::Dynamic> &dst, Eigen::Matrix3d *rotation,
@@ -230,8 +342,12 @@ void teaser::FastGlobalRegistrationSolver::solveForRotation(
     // stopping condition for mu
     double min_mu = 1.0;
     *rotation = Eigen::Matrix3d::Identity(3, 3); // rotation matrix
-    Eigen::Matrix<double, 1, Eigen::Dynamic> l_pq(1, match_size);
-    l_pq.setOnes(1, match_size);
+    double *l_pq_data = workspace_.weightsBuffer(match_size);
+    double *residuals_data = workspace_.residualsBuffer(match_size);
+    typedef RotationWorkspace<3>::RowArray RowArray;
+    Eigen::Map<RowArray> l_pq(l_pq_data, match_size), residuals_sq(residuals_data, match_size);
+    l_pq.setOnes();
+    RotationWorkspace<3>::residuals(src, dst, *rotation, residuals_data);
 
     // Assumptions of the two inputs:
     // they should be of the same scale,
@@ -240,24 +356,15 @@ void teaser::FastGlobalRegistrationSolver::solveForRotation(
     for (size_t i = 0; i < params_.max_iterations; ++i) {
         double scaled_mu = mu * noise_bound_sq;
 
-        // 1. Optimize for line processes weights
-        Eigen::Matrix<double, 3, 1> q, p, rpq;
-        for (size_t j = 0; j < match_size; ++j) {
-            // p = Rq
-            q = src.col(j);
-            p = dst.col(j);
-            rpq = p - (*rotation) * q;
-            l_pq(j) = std::pow(scaled_mu / (scaled_mu + rpq.squaredNorm()), 2);
-        }
+        // 1. Optimize for line processes weights, the residuals are the ones of the current rotation
+        l_pq = (scaled_mu / (scaled_mu + residuals_sq)).square();
 
         // 2. Optimize for Rotation Matrix
-        *rotation = gtsam::svdRot(src, dst, l_pq);
+        *rotation = RotationWorkspace<3>::weightedRotation(src, dst, l_pq_data);
 
         // update cost
-        Eigen::Matrix<double, 3, Eigen::Dynamic> diff = (dst - (*rotation) * src).array().square();
-        cost_ = ((scaled_mu * diff.colwise().sum()).array() /
-                 (scaled_mu + diff.colwise().sum().array()).array())
-                .sum();
+        RotationWorkspace<3>::residuals(src, dst, *rotation, residuals_data);
+        cost_ = (scaled_mu * residuals_sq / (scaled_mu + residuals_sq)).sum();
 
         // additional termination conditions
         if (cost_ < params_.cost_threshold || mu < min_mu) {
@@ -273,7 +380,7 @@ void teaser::FastGlobalRegistrationSolver::solveForRotation(
     }
 
     if (inliers) {
-        *inliers = l_pq.cast<bool>();
+        *inliers = l_pq != 0;
     }
 }
 
@@ -291,7 +398,7 @@ void teaser::TLSScaleSolver::solveForScale(const Eigen::Matrix<double, 3, Eigen:
     double beta = 2 * noise_bound_ * sqrt(cbar2_);
     Eigen::Matrix<double, 1, Eigen::Dynamic> alphas = beta * v1_dist.cwiseInverse();
 
-    tls_estimator_.estimate(raw_scales, alphas, scale, inliers);
+    tls_estimator_.estimate_radix(raw_scales, alphas, scale, inliers);
 }
 
 void teaser::ScaleInliersSelector::solveForScale(
@@ -333,7 +440,7 @@ void teaser::TLSTranslationSolver::solveForTranslation(
     *inliers = Eigen::Matrix<bool, 1, Eigen::Dynamic>::Ones(1, N);
     Eigen::Matrix<bool, 1, Eigen::Dynamic> inliers_temp(1, N);
     for (size_t i = 0; i < raw_translation.rows(); ++i) {
-        tls_estimator_.estimate(raw_translation.row(i), alphas, &((*translation)(i)), &inliers_temp);
+        tls_estimator_.estimate_radix(raw_translation.row(i), alphas, &((*translation)(i)), &inliers_temp);
         // element-wise AND using component-wise product (Eigen 3.2 compatible)
         // a point is an inlier iff. x,y,z are all inliers
         *inliers = (*inliers).cwiseProduct(inliers_temp);
@@ -348,42 +455,71 @@ teaser::RobustRegistrationSolver::RobustRegistrationSolver(
 Eigen::Matrix<double, 3, Eigen::Dynamic>
 teaser::RobustRegistrationSolver::computeTIMs(const Eigen::Matrix<double, 3, Eigen::Dynamic> &v,
                                               Eigen::Matrix<int, 2, Eigen::Dynamic> *map) {
+    Eigen::Matrix<double, 3, Eigen::Dynamic> vtilde; // v 波浪线, complete graph
+    computeTIMs(v, nullptr, INLIER_GRAPH_FORMULATION::COMPLETE, &vtilde, map);
+    return vtilde;
+}
 
-    auto N = v.cols();
-    Eigen::Matrix<double, 3, Eigen::Dynamic> vtilde(3, N * (N - 1) / 2); // v 波浪线, complete graph
-    map->resize(2, N * (N - 1) / 2); // use upper triangular matrix to store the symmetric matrix
-
-#pragma omp parallel for default(none) shared(N, v, vtilde, map)
-    for (size_t i = 0; i < N - 1; i++) {
-        // Calculate some important indices
-        // For each measurement, we compute the TIMs between itself and all the measurements after it.
-        // For example:
-        // i=0: add N-1 TIMs
-        // i=1: add N-2 TIMs
-        // etc..
-        // i=k: add N-1-k TIMs
-        // And by arithmatic series, we can get the starting index of each segment be:
-        // k*N - k*(k+1)/2
-        size_t segment_start_idx = i * N - i * (i + 1) / 2;
-        size_t segment_cols = N - 1 - i;
-
-        // calculate TIM vk(k=i+1,...,N)-vi
-        Eigen::Matrix<double, 3, 1> m = v.col(i);
-        Eigen::Matrix<double, 3, Eigen::Dynamic> temp = v - m * Eigen::MatrixXd::Ones(1, N);
-
-        // concatenate to the end of the tilde vector
-        vtilde.middleCols(segment_start_idx, segment_cols) = temp.rightCols(segment_cols);
-
-        // populate the index map
-        Eigen::Matrix<int, 2, Eigen::Dynamic> map_addition(2, N);
-        for (size_t j = 0; j < N; ++j) {
-            map_addition(0, j) = i;
-            map_addition(1, j) = j;
+void teaser::RobustRegistrationSolver::computeTIMs(const Eigen::Matrix<double, 3, Eigen::Dynamic> &v,
+                                                   const std::vector<int> *clique,
+                                                   INLIER_GRAPH_FORMULATION formulation,
+                                                   Eigen::Matrix<double, 3, Eigen::Dynamic> *tims,
+                                                   Eigen::Matrix<int, 2, Eigen::Dynamic> *map) {
+    const Eigen::Index N = clique ? clique->size() : v.cols();
+    auto column = [clique](Eigen::Index k) -> Eigen::Index { return clique ? (*clique)[k] : k; };
+
+    if (formulation == INLIER_GRAPH_FORMULATION::CHAIN) {
+        tims->resize(3, N);
+        if (map) {
+            map->resize(2, N);
         }
-        map->middleCols(segment_start_idx, segment_cols) = map_addition.rightCols(segment_cols);
+        for (Eigen::Index k = 0; k < N; ++k) {
+            Eigen::Index root = column(k), leaf = column(k + 1 == N ? 0 : k + 1);
+            tims->col(k) = v.col(leaf) - v.col(root);
+            if (map) {
+                (*map)(0, k) = leaf;
+                (*map)(1, k) = root;
+            }
+        }
+        return;
     }
 
-    return vtilde;
+    // use upper triangular matrix to store the symmetric matrix, row i holds the N-1-i TIMs v_j - v_i with j > i
+    // and starts at column i*N - i*(i+1)/2
+    const Eigen::Index M = N * (N - 1) / 2;
+    tims->resize(3, M);
+    if (map) {
+        map->resize(2, M);
+    }
+    // 3 x 512 doubles and the 2 x 512 map of a block take 16 KB, the rows are too uneven to split the work
+    constexpr Eigen::Index block_size = 512;
+    const Eigen::Index num_blocks = (M + block_size - 1) / block_size;
+    auto row_start = [N](Eigen::Index i) { return i * N - i * (i + 1) / 2; };
+#pragma omp parallel for schedule(static)
+    for (Eigen::Index b = 0; b < num_blocks; ++b) {
+        Eigen::Index k = b * block_size, end = std::min(M, k + block_size);
+        // the row holding TIM k, from the inverse of row_start and corrected for rounding
+        const double c = 2 * N - 1;
+        Eigen::Index i = std::max<Eigen::Index>(0, static_cast<Eigen::Index>((c - std::sqrt(c * c - 8.0 * k)) / 2));
+        while (i > 0 && row_start(i) > k) {
+            --i;
+        }
+        while (row_start(i + 1) <= k) {
+            ++i;
+        }
+        Eigen::Index j = i + 1 + (k - row_start(i));
+        for (; k < end; ++k) {
+            tims->col(k) = v.col(column(j)) - v.col(column(i));
+            if (map) {
+                (*map)(0, k) = i;
+                (*map)(1, k) = j;
+            }
+            if (++j == N) {
+                ++i;
+                j = i + 1;
+            }
+        }
+    }
 }
 
 teaser::RegistrationSolution
@@ -487,44 +623,11 @@ teaser::RobustRegistrationSolver::solve(const Eigen::Matrix<double, 3, Eigen::Dy
     }
 
     // Calculate new measurements & TIMs based on max clique inliers
-    if (params_.rotation_tim_graph == INLIER_GRAPH_FORMULATION::CHAIN) {
-        // chain graph 知道正确的匹配关系（可能还含有一些外点）后，用chain graph来构造TIMS来估计R
-        TEASER_DEBUG_INFO_MSG("Using chain graph for GNC rotation.");
-        pruned_src_tims_.resize(3, max_clique_.size());
-        pruned_dst_tims_.resize(3, max_clique_.size());
-        src_tims_map_rotation_.resize(2, max_clique_.size());
-        dst_tims_map_rotation_.resize(2, max_clique_.size());
-        for (size_t i = 0; i < max_clique_.size(); ++i) {
-            const auto &root = max_clique_[i];
-            int leaf;
-            if (i != max_clique_.size() - 1) {
-                leaf = max_clique_[i + 1];
-            } else {
-                leaf = max_clique_[0];
-            }
-            pruned_src_tims_.col(i) = src.col(leaf) - src.col(root);
-            pruned_dst_tims_.col(i) = dst.col(leaf) - dst.col(root);
-
-            // populate the TIMs map
-            dst_tims_map_rotation_(0, i) = leaf;
-            dst_tims_map_rotation_(1, i) = root;
-            src_tims_map_rotation_(0, i) = leaf;
-            src_tims_map_rotation_(1, i) = root;
-        }
-    } else {
-        // complete graph
-        TEASER_DEBUG_INFO_MSG("Using complete graph for GNC rotation.");
-        // select the inlier measurements with max clique
-        Eigen::Matrix<double, 3, Eigen::Dynamic> src_inliers(3, max_clique_.size());
-        Eigen::Matrix<double, 3, Eigen::Dynamic> dst_inliers(3, max_clique_.size());
-        for (size_t i = 0; i < max_clique_.size(); ++i) {
-            src_inliers.col(i) = src.col(max_clique_[i]);
-            dst_inliers.col(i) = dst.col(max_clique_[i]);
-        }
-        // construct the TIMs
-        pruned_dst_tims_ = computeTIMs(dst_inliers, &dst_tims_map_rotation_);
-        pruned_src_tims_ = computeTIMs(src_inliers, &src_tims_map_rotation_);
-    }
+    // chain graph 知道正确的匹配关系（可能还含有一些外点）后，用chain graph来构造TIMS来估计R
+    TEASER_DEBUG_INFO_MSG("Using " << (params_.rotation_tim_graph == INLIER_GRAPH_FORMULATION::CHAIN ?
+                                       "chain" : "complete") << " graph for GNC rotation.");
+    computeTIMs(src, &max_clique_, params_.rotation_tim_graph, &pruned_src_tims_, &src_tims_map_rotation_);
+    computeTIMs(dst, &max_clique_, params_.rotation_tim_graph, &pruned_dst_tims_, &dst_tims_map_rotation_);
 
     // Remove scaling for rotation estimation
     pruned_dst_tims_ *= (1 / solution_.scale);
@@ -611,19 +714,12 @@ void teaser::GNCTLSRotationSolver::solveForRotation(
      * Loop: terminate when:
      *    1. the change in cost in two consecutive runs is smaller than a user-defined threshold
      *    2. # iterations exceeds the maximum allowed
+     *    3. the weights are binary and did not change, i.e. the loop reached a fixed point
      *
      * Within each loop:
      * 1. fix weights and solve for R
      * 2. fix R and solve for weights
      */
-
-    // Prepare some variables
-    size_t match_size = src.cols(); // number of correspondences
-
-    double mu = 1; // arbitrary starting mu
-
-    double prev_cost = std::numeric_limits<double>::infinity();
-    cost_ = std::numeric_limits<double>::infinity();
     double noise_bound_sq = std::pow(params_.noise_bound, 2);
     if (noise_bound_sq < 1e-16) {
         noise_bound_sq = 1e-2;
@@ -631,70 +727,91 @@ void teaser::GNCTLSRotationSolver::solveForRotation(
     TEASER_DEBUG_INFO_MSG("GNC rotation estimation noise bound:" << params_.noise_bound);
     TEASER_DEBUG_INFO_MSG("GNC rotation estimation noise bound squared:" << noise_bound_sq);
 
-    Eigen::Matrix<double, 3, Eigen::Dynamic> diffs(3, match_size);
-    Eigen::Matrix<double, 1, Eigen::Dynamic> weights(1, match_size);
-    weights.setOnes(1, match_size);
-    Eigen::Matrix<double, 1, Eigen::Dynamic> residuals_sq(1, match_size);
+    size_t iterations = workspace_.solveGncTls(src, dst, noise_bound_sq, params_.gnc_factor,
+                                               params_.cost_threshold, params_.max_iterations, rotation, &cost_);
+    TEASER_DEBUG_INFO_MSG("GNC-TLS iterations: " << iterations);
 
-    // Loop for performing GNC-TLS
-    for (size_t i = 0; i < params_.max_iterations; ++i) {
+    if (inliers) {
+        *inliers = workspace_.weights().array() >= 0.5;
+    }
+}
 
+template<int D>
+typename teaser::RotationWorkspace<D>::MatrixD
+teaser::RotationWorkspace<D>::weightedRotation(const MatrixDX &src, const MatrixDX &dst, const double *weights) {
+    // Assemble the correlation matrix H = X * W * Y'
+    MatrixD H = MatrixD::Zero();
+    for (Eigen::Index j = 0; j < src.cols(); ++j) {
+        if (weights[j] != 0) {
+            H.noalias() += (weights[j] * src.col(j)) * dst.col(j).transpose();
+        }
+    }
+
+    Eigen::JacobiSVD<MatrixD> svd(H, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    MatrixD U = svd.matrixU();
+    MatrixD V = svd.matrixV();
+    if (U.determinant() * V.determinant() < 0) {
+        V.col(D - 1) *= -1;
+    }
+    return V * U.transpose();
+}
+
+template<int D>
+void teaser::RotationWorkspace<D>::residuals(const MatrixDX &src, const MatrixDX &dst, const MatrixD &rotation,
+                                             double *residuals_sq) {
+    for (Eigen::Index j = 0; j < src.cols(); ++j) {
+        residuals_sq[j] = (dst.col(j) - rotation * src.col(j)).squaredNorm();
+    }
+}
+
+template<int D>
+size_t teaser::RotationWorkspace<D>::solveGncTls(const MatrixDX &src, const MatrixDX &dst, double noise_bound_sq,
+                                                 double gnc_factor, double cost_threshold, size_t max_iterations,
+                                                 MatrixD *rotation, double *cost) {
+    const size_t match_size = src.cols();
+    reserve(match_size);
+    Eigen::Map<RowArray> weights(weights_.data(), match_size);
+    Eigen::Map<RowArray> next_weights(next_weights_.data(), match_size);
+    Eigen::Map<RowArray> residuals_sq(residuals_sq_.data(), match_size);
+    weights.setOnes();
+
+    double mu = 1; // arbitrary starting mu
+    double prev_cost = std::numeric_limits<double>::infinity();
+    *cost = std::numeric_limits<double>::infinity();
+    size_t i = 0;
+    while (i < max_iterations) {
+        ++i;
         // Fix weights and perform SVD rotation estimation
-        *rotation = gtsam::svdRot(src, dst, weights);
-
-        // Calculate residuals squared
-        diffs = (dst - (*rotation) * src).array().square();
-        residuals_sq = diffs.colwise().sum();
-        if (i == 0) {
-            // Initialize rule for mu
-            double max_residual = residuals_sq.maxCoeff();
-            mu = 1 / (2 * max_residual / noise_bound_sq - 1);
-            // Degenerate case: mu = -1 because max_residual is very small
-            // i.e., little to none noise
+        *rotation = weightedRotation(src, dst, weights_.data());
+        residuals(src, dst, *rotation, residuals_sq_.data());
+        if (i == 1) {
+            // Initialize rule for mu, mu <= 0 means little to none noise
+            mu = 1 / (2 * residuals_sq.maxCoeff() / noise_bound_sq - 1);
             if (mu <= 0) {
-                TEASER_DEBUG_INFO_MSG(
-                        "GNC-TLS terminated because maximum residual at initialization is very small.");
                 break;
             }
         }
 
         // Fix R and solve for weights in closed form
-        double th1 = (mu + 1) / mu * noise_bound_sq;
-        double th2 = mu / (mu + 1) * noise_bound_sq;
-        cost_ = 0;
-        for (size_t j = 0; j < match_size; ++j) {
-            // Also calculate cost in this loop
-            // Note: the cost calculated is using the previously solved weights
-            cost_ += weights(j) * residuals_sq(j);
-
-            if (residuals_sq(j) >= th1) {
-                weights(j) = 0;
-            } else if (residuals_sq(j) <= th2) {
-                weights(j) = 1;
-            } else {
-                weights(j) = sqrt(noise_bound_sq * mu * (mu + 1) / residuals_sq(j)) - mu;
-                assert(weights(j) >= 0 && weights(j) <= 1);
-            }
-        }
-
-        // Calculate cost
-        double cost_diff = std::abs(cost_ - prev_cost);
-
-        // Increase mu
-        mu = mu * params_.gnc_factor;
-        prev_cost = cost_;
-
-        if (cost_diff < params_.cost_threshold) {
-            TEASER_DEBUG_INFO_MSG("GNC-TLS solver terminated due to cost convergence.");
-            TEASER_DEBUG_INFO_MSG("Cost diff: " << cost_diff);
-            TEASER_DEBUG_INFO_MSG("Iterations: " << i);
+        // Note: the cost is calculated with the previously solved weights
+        *cost = (weights * residuals_sq).sum();
+        const double th1 = (mu + 1) / mu * noise_bound_sq;
+        const double th2 = mu / (mu + 1) * noise_bound_sq;
+        next_weights = (residuals_sq >= th1).select(
+                0.0, (residuals_sq <= th2).select(1.0, (noise_bound_sq * mu * (mu + 1) / residuals_sq).sqrt() - mu));
+        // binary weights that did not change give the same rotation, so they stay binary and unchanged
+        const bool fixed_point = (next_weights == weights).all() && (next_weights * (1 - next_weights) == 0).all();
+        weights = next_weights;
+
+        double cost_diff = std::abs(*cost - prev_cost);
+        mu = mu * gnc_factor;
+        prev_cost = *cost;
+        if (cost_diff < cost_threshold || fixed_point) {
             break;
         }
     }
-
-    if (inliers) {
-        for (size_t i = 0; i < weights.cols(); ++i) {
-            (*inliers)(0, i) = weights(0, i) >= 0.5;
-        }
-    }
+    return i;
 }
+
+template class teaser::RotationWorkspace<2>;
+template class teaser::RotationWorkspace<3>;
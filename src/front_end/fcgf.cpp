@@ -7,6 +7,14 @@
 #include "front_end/fcgf.h"
 #include "datasets/datasets_init.h"
 #include <robot_utils/file_manager.h>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <algorithm>
 
 using namespace g3reg;
 
@@ -32,6 +40,145 @@ namespace fcgf {
         }
     }
 
+    bool Correspondences::load(const std::string &path) {
+        file_.close();
+        parsed_.clear();
+        data_ = nullptr;
+        rows_ = 0;
+        is_float_ = false;
+        if (path.size() > 4 && path.compare(path.size() - 4, 4, ".npy") == 0) {
+            return loadNpy(path);
+        }
+        return loadText(path);
+    }
+
+    bool Correspondences::loadNpy(const std::string &path) {
+        if (!file_.open(path)) {
+            return false;
+        }
+        const char *bytes = file_.data();
+        size_t size = file_.size();
+        // magic string, version, header length (2 bytes in version 1, 4 bytes afterwards)
+        if (size < 10 || std::memcmp(bytes, "\x93NUMPY", 6) != 0) {
+            LOG(ERROR) << "Not a npy file " << path;
+            return false;
+        }
+        size_t header_len, header_start;
+        if (bytes[6] == 1) {
+            header_len = uint8_t(bytes[8]) | (uint8_t(bytes[9]) << 8);
+            header_start = 10;
+        } else {
+            if (size < 12) {
+                return false;
+            }
+            header_len = uint8_t(bytes[8]) | (uint8_t(bytes[9]) << 8) | (uint8_t(bytes[10]) << 16) |
+                         (size_t(uint8_t(bytes[11])) << 24);
+            header_start = 12;
+        }
+        if (header_start + header_len > size) {
+            return false;
+        }
+        std::string header(bytes + header_start, header_len);
+        if (header.find("'fortran_order': False") == std::string::npos) {
+            LOG(ERROR) << "Only C-ordered correspondences are supported " << path;
+            return false;
+        }
+        if (header.find("'<f8'") != std::string::npos) {
+            is_float_ = false;
+        } else if (header.find("'<f4'") != std::string::npos) {
+            is_float_ = true;
+        } else {
+            LOG(ERROR) << "Only float64/float32 correspondences are supported " << path;
+            return false;
+        }
+        size_t shape_pos = header.find("'shape': (");
+        if (shape_pos == std::string::npos) {
+            return false;
+        }
+        char *end;
+        size_t rows = std::strtoull(header.c_str() + shape_pos + 10, &end, 10);
+        while (*end == ',' || *end == ' ') {
+            end++;
+        }
+        if (std::strtoull(end, nullptr, 10) != 6) {
+            LOG(ERROR) << "Correspondences must be N x 6 " << path;
+            return false;
+        }
+        size_t data_start = header_start + header_len;
+        if (data_start + rows * 6 * (is_float_ ? sizeof(float) : sizeof(double)) > size) {
+            LOG(ERROR) << "Truncated npy file " << path;
+            return false;
+        }
+        data_ = bytes + data_start;
+        rows_ = rows;
+        return true;
+    }
+
+    bool Correspondences::loadText(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        // one read of the whole file and strtod over it, instead of a stream per line. Lines are terminated in
+        // place so that a short row cannot take the numbers of the next one
+        std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        size_t line_start = 0;
+        for (int line_idx = 1; line_start < buffer.size(); line_idx++) {
+            size_t line_end = std::min(buffer.find('\n', line_start), buffer.size());
+            if (line_end < buffer.size()) {
+                buffer[line_end] = '\0';
+            }
+            const char *cursor = buffer.c_str() + line_start;
+            line_start = line_end + 1;
+            int count = 0;
+            char *end;
+            for (; count < 6; count++) {
+                double value = std::strtod(cursor, &end);
+                if (end == cursor) {
+                    break;
+                }
+                parsed_.push_back(value);
+                cursor = end;
+            }
+            while (std::isspace(static_cast<unsigned char>(*cursor))) {
+                cursor++;
+            }
+            if (count == 0 && *cursor == '\0') {
+                continue;
+            }
+            if (count < 6 || *cursor != '\0') {
+                LOG(ERROR) << "Expected 6 numbers at line " << line_idx << " of " << path;
+                parsed_.clear();
+                return false;
+            }
+        }
+        data_ = reinterpret_cast<const char *>(parsed_.data());
+        rows_ = parsed_.size() / 6;
+        return true;
+    }
+
+    bool WriteNpy(const std::string &path, const double *data, size_t rows) {
+        std::string header = "{'descr': '<f8', 'fortran_order': False, 'shape': (" + std::to_string(rows) + ", 6), }";
+        // magic (6) + version (2) + length (2) + header, padded with spaces to 64 bytes and ended by a newline
+        size_t total = 10 + header.size() + 1;
+        header.append((64 - total % 64) % 64, ' ');
+        header.push_back('\n');
+        std::string tmp_path = path + ".tmp";
+        FILE *file = fopen(tmp_path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        const char magic[8] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+        uint16_t header_len = header.size();
+        char len_bytes[2] = {char(header_len & 0xff), char(header_len >> 8)};
+        bool ok = fwrite(magic, 1, 8, file) == 8 && fwrite(len_bytes, 1, 2, file) == 2 &&
+                  fwrite(header.data(), 1, header.size(), file) == header.size() &&
+                  fwrite(data, sizeof(double), rows * 6, file) == rows * 6;
+        ok = fclose(file) == 0 && ok;
+        // rename so that a concurrent reader never sees a partial file
+        return ok && std::rename(tmp_path.c_str(), path.c_str()) == 0;
+    }
+
     clique_solver::Association matching(std::tuple<int, int, int> pair_info,
                                         std::vector<clique_solver::GraphVertex::Ptr> &src_nodes,
                                         std::vector<clique_solver::GraphVertex::Ptr> &tgt_nodes) {
@@ -40,28 +187,39 @@ namespace fcgf {
         int src_id = std::get<1>(pair_info);
         int tgt_id = std::get<2>(pair_info);
         std::string fcgf_dir = GetFCGFDir(seq);
-        std::string fcgf_corr_path = FileManager::JoinPath(fcgf_dir,
-                                                           std::to_string(src_id) + "_" + std::to_string(tgt_id) +
-                                                           ".txt");
-        std::ifstream fcgf_corr_file(fcgf_corr_path);
-        if (!fcgf_corr_file.is_open()) {
-            LOG(ERROR) << "Cannot open file " << fcgf_corr_path;
-            throw std::runtime_error("Cannot open file " + fcgf_corr_path);
-        }
-        // read the correspondences N x 6
-        std::vector<Eigen::Vector3d> src_ds, tgt_ds;
-        std::string line;
-        while (std::getline(fcgf_corr_file, line)) {
-            std::istringstream iss(line);
-            Eigen::Vector3d src, tgt;
-            iss >> src(0) >> src(1) >> src(2) >> tgt(0) >> tgt(1) >> tgt(2);
-            src_ds.push_back(src);
-            tgt_ds.push_back(tgt);
+        std::string fcgf_corr_name = std::to_string(src_id) + "_" + std::to_string(tgt_id);
+        std::string npy_path = FileManager::JoinPath(fcgf_dir, fcgf_corr_name + ".npy");
+        std::string txt_path = FileManager::JoinPath(fcgf_dir, fcgf_corr_name + ".txt");
+        // read the correspondences N x 6, the binary file is preferred and written next to the text file once parsed,
+        // unless the text file was modified after it, e.g. regenerated with another model
+        bool npy_fresh = false;
+        if (config.corr_cache) {
+            std::error_code npy_error, txt_error;
+            auto npy_time = std::filesystem::last_write_time(npy_path, npy_error);
+            auto txt_time = std::filesystem::last_write_time(txt_path, txt_error);
+            npy_fresh = !npy_error && (txt_error || txt_time <= npy_time);
+        }
+        Correspondences corrs;
+        if (!npy_fresh || !corrs.load(npy_path)) {
+            if (!corrs.load(txt_path)) {
+                LOG(ERROR) << "Cannot read correspondences from " << txt_path;
+                throw std::runtime_error("Cannot read correspondences from " + txt_path);
+            }
+            if (config.corr_cache) {
+                std::vector<double> rows(corrs.rows() * 6);
+                for (size_t i = 0; i < corrs.rows(); i++) {
+                    Eigen::Map<Eigen::Vector3d>(&rows[i * 6]) = corrs.src(i);
+                    Eigen::Map<Eigen::Vector3d>(&rows[i * 6 + 3]) = corrs.tgt(i);
+                }
+                if (!WriteNpy(npy_path, rows.data(), corrs.rows())) {
+                    LOG(WARNING) << "Cannot cache correspondences to " << npy_path;
+                }
+            }
         }
 
         std::vector<int> indices;
-        indices.reserve(src_ds.size());
-        for (int i = 0; i < src_ds.size(); ++i) {
+        indices.reserve(corrs.rows());
+        for (int i = 0; i < corrs.rows(); ++i) {
             indices.push_back(i);
         }
         if (indices.size() > config.max_corrs && config.back_end != "ransac") {
@@ -82,9 +240,9 @@ namespace fcgf {
         tgt_nodes.reserve(indices.size());
 
         for (int i = 0; i < indices.size(); i++) {
-            const Eigen::Vector3d &center = src_ds[indices[i]];
+            const Eigen::Vector3d center = corrs.src(indices[i]);
             src_nodes.push_back(clique_solver::create_vertex(center, config.vertex_info));
-            const Eigen::Vector3d &center_tgt = tgt_ds[indices[i]];
+            const Eigen::Vector3d center_tgt = corrs.tgt(indices[i]);
             tgt_nodes.push_back(clique_solver::create_vertex(center_tgt, config.vertex_info));
         }
         return assoc;
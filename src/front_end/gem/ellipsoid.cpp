@@ -11,6 +11,7 @@
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include "front_end/gem/gem_matching.h"
+#include "utils/trace.h"
 
 namespace g3reg {
 
@@ -330,10 +331,16 @@ namespace g3reg {
                                                           std::vector<clique_solver::GraphVertex::Ptr> &tgt_nodes) {
         robot_utils::TicToc tic_toc;
         double extract_time = 0, assoc_time = 0, node_time = 0;
-        extractFeatures(src_cloud, tgt_cloud);
+        {
+            G3REG_TRACE_SCOPE("gem/extract_features");
+            extractFeatures(src_cloud, tgt_cloud);
+        }
         extract_time = tic_toc.toc();
 
-        associateAdvanced();
+        {
+            G3REG_TRACE_SCOPE("gem/association");
+            associateAdvanced();
+        }
         assoc_time = tic_toc.toc();
 
         // construct the matching node pairs
@@ -7,6 +7,7 @@
 #include "front_end/graph_vertex.h"
 #include "robot_utils/tic_toc.h"
 #include "front_end/gem/clustering.h"
+#include "utils/trace.h"
 #include <pcl/io/pcd_io.h>
 #include <unsupported/Eigen/MatrixFunctions>
 
@@ -16,13 +17,17 @@ namespace g3reg {
                                       std::vector<LineFeature::Ptr> &line_features,
                                       std::vector<SurfaceFeature::Ptr> &surface_features,
                                       std::vector<ClusterFeature::Ptr> &cluster_features) {
+        G3REG_TRACE_SCOPE("gem/extract_cloud");
         reset();
 
         robot_utils::TicToc t;
         double tSrc, ground_time, plane_time, cluster_time, line_time;
         pcl::PointCloud<pcl::PointXYZ> cloud_ground;
         pcl::PointCloud<pcl::PointXYZ> cloud_nonground;
-        travel::estimateGround(*cloud_xyz, cloud_ground, cloud_nonground, tSrc);
+        {
+            G3REG_TRACE_SCOPE("gem/ground_segmentation");
+            travel::estimateGround(*cloud_xyz, cloud_ground, cloud_nonground, tSrc);
+        }
         ground_time = t.toc();
 
         cutCloud(cloud_nonground, FeatureType::None, config.plane_resolution, voxel_map);
@@ -35,6 +40,7 @@ namespace g3reg {
                     }
                 }
             }
+            G3REG_TRACE_SCOPE("gem/plane_merging");
             MergePlanes(surface_features);
             FilterSurface(surface_features, config.min_cluster_size);
             plane_time = t.toc();
@@ -53,15 +59,19 @@ namespace g3reg {
             }
         }
 
-        if (config.cluster_mtd == "travel") {
-            travel::Cluster(other_cloud, cluster_features, false);
-        } else if (config.cluster_mtd == "dcvc") {
-            DCVC::Cluster(other_cloud, cluster_features, false);
+        {
+            G3REG_TRACE_SCOPE("gem/clustering");
+            if (config.cluster_mtd == "travel") {
+                travel::Cluster(other_cloud, cluster_features, false);
+            } else if (config.cluster_mtd == "dcvc") {
+                DCVC::Cluster(other_cloud, cluster_features, false);
+            }
         }
 
         cluster_time = t.toc();
 
         if (config.num_lines > 0) {
+            G3REG_TRACE_SCOPE("gem/pole_extraction");
             ExtractPole(cluster_features, line_features);
             for (int i = 0; i < line_features.size(); ++i) {
                 LineFeature::Ptr line_feature = line_features[i];
@@ -296,6 +306,7 @@ namespace g3reg {
         ellipsoids.push_back(ellipsoid_clusters);
 
         if (config.use_pseudo_cov) {
+            G3REG_TRACE_SCOPE("gem/obb_fitting");
             for (int i = 0; i < ellipsoids.size(); ++i) {
                 for (int j = 0; j < ellipsoids[i].size(); ++j) {
                     ellipsoids[i][j]->fitting();
@@ -9,6 +9,20 @@
 
 namespace clique_solver {
 
+    Eigen::VectorXd GraphVertex::consistentHeight(const GraphVertex &other) {
+        const double &meas = std::abs(centroid.z() - other.centroid.z());
+
+        Eigen::VectorXd prob = Eigen::VectorXd::Zero(num_graphs());
+        // noise bound vector is in ascending order, once a level is consistent so are the looser ones
+        for (int level = 0; level < num_graphs(); ++level) {
+            if (meas < 2 * vertex_info_.noise_bound_vec[level]) {
+                prob.tail(num_graphs() - level).setConstant(0.99);
+                break;
+            }
+        }
+        return prob;
+    }
+
     GraphVertex::Ptr EllipseVertex::operator-(const GraphVertex &other) const {
         const Eigen::Vector3d &diff = centroid - other.centroid;
         const Eigen::Matrix3d &cov = covariance + other.covariance;
@@ -65,6 +79,23 @@ namespace clique_solver {
         return prob;
     }
 
+    Eigen::VectorXd EllipseVertex::consistentHeight(const GraphVertex &other) {
+        const double &meas = std::abs(centroid.z() - other.centroid.z());
+        // vertical variances, bounded like the spectral radii in consistent()
+        const double var1 = std::min(covariance(2, 2), vertex_info_.prior_bound);
+        const double var2 = std::min(other.covariance(2, 2), other.vertex_info_.prior_bound);
+
+        Eigen::VectorXd prob = Eigen::VectorXd::Zero(num_graphs());
+        for (int level = 0; level < num_graphs(); ++level) {
+            const double &chi_square = vertex_info_.noise_bound_vec[level];
+            if (meas < sqrt(var1 * chi_square) + sqrt(var2 * chi_square)) {
+                prob.tail(num_graphs() - level).setConstant(0.99);
+                break;
+            }
+        }
+        return prob;
+    }
+
     GraphVertex::Ptr GaussianVertex::operator-(const GraphVertex &other) const {
         const Eigen::Matrix3d &sum_covariance = covariance + other.covariance;
         const Eigen::Vector3d &diff = centroid - other.centroid;
@@ -171,6 +202,21 @@ namespace clique_solver {
         return prob;
     }
 
+    Eigen::VectorXd PointRatioVertex::consistentHeight(const GraphVertex &other) {
+        // the ratio bound of consistent() as a distance, relative to the shorter TIM
+        const double &meas = std::abs(centroid.z() - other.centroid.z());
+        const double &length = std::min(this->norm(), other.norm());
+
+        Eigen::VectorXd prob = Eigen::VectorXd::Zero(num_graphs());
+        for (int level = 0; level < num_graphs(); ++level) {
+            if (meas < 2 * vertex_info_.noise_bound_vec[level] * length) {
+                prob.tail(num_graphs() - level).setConstant(0.99);
+                break;
+            }
+        }
+        return prob;
+    }
+
     clique_solver::GraphVertex::Ptr
     create_vertex(const Eigen::Vector3d &center, const VertexInfo &vertex_info, const Eigen::Matrix3d &cov,
                   const double &prior_bound) {
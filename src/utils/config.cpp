@@ -8,6 +8,7 @@
 #include <glog/logging.h>
 #include "global_definition/global_definition.h"
 #include <filesystem>
+#include <stdexcept>
 
 namespace g3reg {
 
@@ -33,6 +34,18 @@ namespace g3reg {
 
         min_range = 0.5;
         max_range = 120.0;
+        crop_on_load = false;
+        pose_cache = true;
+        corr_cache = true;
+        deskew_mode = "exact";
+        deskew_bins = 4096;
+        // opt-in, background loading shares the cores with the timed registration
+        prefetch_pairs = 0;
+        prefetch_threads = 1;
+        prefetch_memory_mb = 2048;
+        prefetch_voxel_size = 0;
+        trace_stages = false;
+        memory_stages = false;
         min_cluster_size = 20;
         ds_resolution = 0.5;
 
@@ -60,6 +73,10 @@ namespace g3reg {
         use_bbox_center = false;
         plane_aided = true;
         grad_pmc = true;
+        mac_solver = "pmc";
+        mac_solver_mode = teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE::PMC_EXACT;
+        tf_batch = false;
+        yaw_only = false;
         volume_chi2 = 7.815;
 
         // vertex parameter
@@ -84,6 +101,14 @@ namespace g3reg {
         ransac_max_iterations = 100000;
         ransac_inlier_threshold = 0.5;
         ransac_inliers_to_end = 0.5;
+        ransac_scoring = "full";
+        ransac_preemptive_hypotheses = 500;
+        ransac_preemptive_block = 100;
+
+        // bounded, so that a dense graph cannot stall the clique search, 0 for no limit
+        mac_max_branches = 64;
+        mac_max_cliques = 1000;
+        mac_time_limit = 1000.0;
 
         normal_radius = 1.0;
         fpfh_radius = 2.5;
@@ -133,6 +158,17 @@ namespace g3reg {
 
         min_range = get(config_node, "dataset", "min_range", min_range);
         max_range = get(config_node, "dataset", "max_range", max_range);
+        crop_on_load = get(config_node, "dataset", "crop_on_load", crop_on_load);
+        pose_cache = get(config_node, "dataset", "pose_cache", pose_cache);
+        corr_cache = get(config_node, "dataset", "corr_cache", corr_cache);
+        deskew_mode = get(config_node, "dataset", "deskew_mode", deskew_mode);
+        deskew_bins = get(config_node, "dataset", "deskew_bins", deskew_bins);
+        prefetch_pairs = get(config_node, "prefetch", "pairs", prefetch_pairs);
+        prefetch_threads = get(config_node, "prefetch", "threads", prefetch_threads);
+        prefetch_memory_mb = get(config_node, "prefetch", "memory_mb", prefetch_memory_mb);
+        prefetch_voxel_size = get(config_node, "prefetch", "voxel_size", prefetch_voxel_size);
+        trace_stages = get(config_node, "trace", "enable", trace_stages);
+        memory_stages = get(config_node, "trace", "memory", memory_stages);
         min_cluster_size = get(config_node, "dataset", "min_cluster_size", min_cluster_size);
         ds_resolution = get(config_node, "dataset", "ds_resolution", ds_resolution);
 
@@ -160,6 +196,18 @@ namespace g3reg {
         use_bbox_center = get(config_node, "use_bbox_center", use_bbox_center);
         plane_aided = get(config_node, "plane_aided", plane_aided);
         grad_pmc = get(config_node, "grad_pmc", grad_pmc);
+        mac_solver = get(config_node, "mac_solver", mac_solver);
+        if (mac_solver == "pmc") {
+            mac_solver_mode = teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE::PMC_EXACT;
+        } else if (mac_solver == "clipper") {
+            mac_solver_mode = teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE::CLIPPER;
+        } else if (mac_solver == "pyclipper") {
+            mac_solver_mode = teaser::RobustRegistrationSolver::INLIER_SELECTION_MODE::PYCLIPPER;
+        } else {
+            throw std::runtime_error("Unknown mac_solver: " + mac_solver + " (pmc, clipper, pyclipper)");
+        }
+        tf_batch = get(config_node, "tf_batch", tf_batch);
+        yaw_only = get(config_node, "yaw_only", yaw_only);
         volume_chi2 = get(config_node, "volume_chi2", volume_chi2);
 
         // vertex parameter
@@ -184,6 +232,14 @@ namespace g3reg {
         ransac_max_iterations = get(config_node, "ransac", "max_iterations", ransac_max_iterations);
         ransac_inlier_threshold = get(config_node, "ransac", "inlier_threshold", ransac_inlier_threshold);
         ransac_inliers_to_end = get(config_node, "ransac", "inliers_to_end", ransac_inliers_to_end);
+        ransac_scoring = get(config_node, "ransac", "scoring", ransac_scoring);
+        ransac_preemptive_hypotheses = get(config_node, "ransac", "preemptive_hypotheses",
+                                           ransac_preemptive_hypotheses);
+        ransac_preemptive_block = get(config_node, "ransac", "preemptive_block", ransac_preemptive_block);
+
+        mac_max_branches = get(config_node, "mac", "max_branches", mac_max_branches);
+        mac_max_cliques = get(config_node, "mac", "max_cliques", mac_max_cliques);
+        mac_time_limit = get(config_node, "mac", "time_limit", mac_time_limit);
 
         if (std::ifstream(fpfh_file)) {
             config_node = YAML::LoadFile(fpfh_file);
@@ -0,0 +1,224 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#include "utils/memory.h"
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <algorithm>
+
+#if defined(G3REG_COUNT_ALLOCS) && defined(__GLIBC__)
+#include <malloc.h>
+#define G3REG_HEAP_HOOK
+#endif
+
+namespace g3reg {
+
+    static std::atomic<size_t> num_allocs(0), num_alloc_bytes(0), heap_live_bytes(0), heap_peak_bytes(0);
+
+    // peak RSS seen by closed outermost scopes, the kernel peak was reset by them
+    static std::atomic<double> carried_rss_peak_mb(0);
+
+    static thread_local MemoryScope *current_scope = nullptr;
+
+    static void raisePeak(size_t bytes) {
+        size_t peak = heap_peak_bytes.load(std::memory_order_relaxed);
+        while (bytes > peak && !heap_peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+    }
+
+#ifdef G3REG_HEAP_HOOK
+    static void countAlloc(void *ptr, size_t size) {
+        if (ptr == nullptr) {
+            return;
+        }
+        size_t usable = malloc_usable_size(ptr);
+        num_allocs.fetch_add(1, std::memory_order_relaxed);
+        num_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+        raisePeak(heap_live_bytes.fetch_add(usable, std::memory_order_relaxed) + usable);
+    }
+
+    static void countFree(void *ptr) {
+        if (ptr != nullptr) {
+            heap_live_bytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+        }
+    }
+#endif
+
+    long ReadStatusKb(const std::string &field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, field.size() + 1, field + ":") == 0) {
+                return std::stol(line.substr(field.size() + 1));
+            }
+        }
+        return -1;
+    }
+
+    double CurrentRssMb() {
+        return ReadStatusKb("VmRSS") / 1024.0;
+    }
+
+    static void clearPeakRss() {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+    }
+
+    double PeakRssMb() {
+        return std::max(ReadStatusKb("VmHWM") / 1024.0, carried_rss_peak_mb.load());
+    }
+
+    void ResetPeakRss() {
+        carried_rss_peak_mb = 0;
+        clearPeakRss();
+    }
+
+    bool HeapCounters::enabled() {
+#ifdef G3REG_HEAP_HOOK
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    HeapCounters HeapCounters::read() {
+        HeapCounters counters;
+        counters.allocs = num_allocs.load(std::memory_order_relaxed);
+        counters.alloc_bytes = num_alloc_bytes.load(std::memory_order_relaxed);
+        counters.live_bytes = heap_live_bytes.load(std::memory_order_relaxed);
+        counters.peak_bytes = std::max(heap_peak_bytes.load(std::memory_order_relaxed), counters.live_bytes);
+        return counters;
+    }
+
+    size_t HeapCounters::resetPeak() {
+        return heap_peak_bytes.exchange(heap_live_bytes.load(std::memory_order_relaxed));
+    }
+
+    void HeapCounters::restorePeak(size_t bytes) {
+        raisePeak(bytes);
+    }
+
+    MemoryScope::MemoryScope(const char *stage, std::vector<StageMemory> *records) : stage_(stage),
+                                                                                       records_(records) {
+        if (records_ == nullptr) {
+            return;
+        }
+        parent_ = current_scope;
+        current_scope = this;
+        heap_peak_before_ = HeapCounters::resetPeak();
+        begin_ = HeapCounters::read();
+        rss_peak_before_ = PeakRssMb();
+        clearPeakRss();
+    }
+
+    MemoryScope::~MemoryScope() {
+        if (records_ == nullptr) {
+            return;
+        }
+        HeapCounters end = HeapCounters::read();
+        StageMemory memory;
+        memory.stage = stage_;
+        memory.allocs = end.allocs - begin_.allocs;
+        memory.alloc_mb = (end.alloc_bytes - begin_.alloc_bytes) / 1048576.0;
+        memory.peak_heap_mb = (end.peak_bytes - std::min(end.peak_bytes, begin_.live_bytes)) / 1048576.0;
+        memory.rss_mb = CurrentRssMb();
+        memory.peak_rss_mb = std::max(ReadStatusKb("VmHWM") / 1024.0, child_rss_peak_);
+        records_->push_back(memory);
+
+        // hand the peaks hidden by this scope's resets to the enclosing window
+        HeapCounters::restorePeak(heap_peak_before_);
+        double window_peak = std::max(rss_peak_before_, memory.peak_rss_mb);
+        if (parent_ != nullptr) {
+            parent_->child_rss_peak_ = std::max(parent_->child_rss_peak_, window_peak);
+        } else {
+            carried_rss_peak_mb = std::max(carried_rss_peak_mb.load(), window_peak);
+        }
+        current_scope = parent_;
+    }
+}
+
+#ifdef G3REG_HEAP_HOOK
+// counting wrappers of the glibc allocator, operator new ends in malloc as well
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    g3reg::countAlloc(ptr, size);
+    return ptr;
+}
+
+void *calloc(size_t num, size_t size) {
+    size_t bytes;
+    if (__builtin_mul_overflow(num, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    void *ptr = __libc_calloc(num, size);
+    g3reg::countAlloc(ptr, bytes);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    g3reg::countFree(ptr);
+    void *new_ptr = __libc_realloc(ptr, size);
+    if (new_ptr == nullptr && size > 0) {
+        // the old block is still alive
+        g3reg::heap_live_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+        return nullptr;
+    }
+    g3reg::countAlloc(new_ptr, size);
+    return new_ptr;
+}
+
+void *memalign(size_t alignment, size_t size) {
+    void *ptr = __libc_memalign(alignment, size);
+    g3reg::countAlloc(ptr, size);
+    return ptr;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void *) != 0) {
+        return EINVAL;
+    }
+    void *new_ptr = memalign(alignment, size);
+    if (new_ptr == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = new_ptr;
+    return 0;
+}
+
+// free() subtracts the usable size of every block, so each allocation entry point must be counted
+void *valloc(size_t size) {
+    void *ptr = __libc_valloc(size);
+    g3reg::countAlloc(ptr, size);
+    return ptr;
+}
+
+void *pvalloc(size_t size) {
+    void *ptr = __libc_pvalloc(size);
+    g3reg::countAlloc(ptr, size);
+    return ptr;
+}
+
+void free(void *ptr) {
+    g3reg::countFree(ptr);
+    __libc_free(ptr);
+}
+}
+#endif
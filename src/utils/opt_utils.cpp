@@ -77,6 +77,35 @@ namespace gtsam {
         return T;
     }
 
+    bool quadricTerm(const QuadricFeature::Ptr &src, const QuadricFeature::Ptr &tgt,
+                     g3reg::GaussianGncTlsSE3::Term &term) {
+        FeatureType type = src->type();
+        if (type != tgt->type() ||
+            (type != FeatureType::Plane && type != FeatureType::Line && type != FeatureType::Cluster)) {
+            return false;
+        }
+        // planes are regularized as RegularizationMethod::PLANE, lines and clusters kept as NONE
+        term = g3reg::GaussianGncTlsSE3::makeTerm(src->center(), tgt->center(), src->sigma(), tgt->sigma(),
+                                                  type == FeatureType::Plane);
+        return true;
+    }
+
+    Eigen::Matrix4d fusedGncQuadricsSE3(const std::vector<g3reg::QuadricFeature::Ptr> &src,
+                                        const std::vector<g3reg::QuadricFeature::Ptr> &tgt,
+                                        const clique_solver::Association &assoc, Eigen::Matrix4d init) {
+        g3reg::GaussianGncTlsSE3 solver;
+        solver.reserve(assoc.rows());
+        g3reg::GaussianGncTlsSE3::Term term;
+        for (int i = 0; i < assoc.rows(); ++i) {
+            if (quadricTerm(src[assoc(i, 0)], tgt[assoc(i, 1)], term)) {
+                solver.add(term);
+            } else {
+                std::cerr << "Unknown semantic type!" << std::endl;
+            }
+        }
+        return solver.solve(init);
+    }
+
     Eigen::Matrix4d gncSE3(const Eigen::Matrix3Xd &src, const Eigen::Matrix3Xd &tgt, Eigen::Matrix4d init) {
 
         // Create a factor graph
@@ -0,0 +1,216 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#include "utils/synthetic.h"
+#include <cmath>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <Eigen/Geometry>
+
+namespace g3reg {
+
+    SyntheticScene::SyntheticScene(const SceneParams &params) : params_(params) {
+        std::mt19937 rng(params_.seed);
+        auto uniform = [&rng](double a, double b) {
+            return std::uniform_real_distribution<double>(a, b)(rng);
+        };
+        double half_length = params_.street_length / 2;
+
+        // facades: blocks of buildings on both sides with gaps for cross streets
+        for (int side: {-1, 1}) {
+            double x = -half_length;
+            while (x < half_length) {
+                double length = uniform(8, 30), depth = uniform(8, 15), height = uniform(6, 25);
+                double offset = params_.facade_offset + uniform(-1, 1);
+                Box box;
+                box.min = Eigen::Vector3d(x, side > 0 ? offset : -offset - depth, 0);
+                box.max = Eigen::Vector3d(x + length, side > 0 ? offset + depth : -offset, height);
+                boxes_.push_back(box);
+                x += length + (uniform(0, 1) < 0.2 ? uniform(6, 12) : uniform(0, 1.5));
+            }
+        }
+        // poles along both curbs
+        for (int side: {-1, 1}) {
+            for (double x = -half_length + uniform(0, params_.pole_spacing); x < half_length;
+                 x += params_.pole_spacing) {
+                cylinders_.push_back({Eigen::Vector2d(x, side * params_.pole_offset), uniform(0.1, 0.2), 0,
+                                      uniform(4, 8)});
+            }
+        }
+        // trees on the sidewalk, a trunk and a wider crown
+        for (int i = 0; i < params_.num_trees; i++) {
+            double side = uniform(0, 1) < 0.5 ? -1 : 1;
+            Eigen::Vector2d center(uniform(-half_length, half_length), side * uniform(9, 10.5));
+            double trunk_height = uniform(2, 3.5);
+            cylinders_.push_back({center, uniform(0.15, 0.3), 0, trunk_height});
+            cylinders_.push_back({center, uniform(1.2, 2.5), trunk_height, trunk_height + uniform(2, 4)});
+        }
+        // parked cars along both curbs
+        for (int i = 0; i < params_.num_cars; i++) {
+            double side = uniform(0, 1) < 0.5 ? -1 : 1;
+            double x = uniform(-half_length, half_length), y = side * uniform(5, 6.5);
+            double length = uniform(4, 5), width = uniform(1.7, 2), height = uniform(1.4, 1.9);
+            boxes_.push_back({Eigen::Vector3d(x - length / 2, y - width / 2, 0),
+                              Eigen::Vector3d(x + length / 2, y + width / 2, height)});
+        }
+    }
+
+    double SyntheticScene::castRay(const Eigen::Vector3d &origin, const Eigen::Vector3d &dir, double max_range) const {
+        double best = max_range;
+        // ground plane z = 0
+        if (dir.z() < -1e-9) {
+            best = std::min(best, -origin.z() / dir.z());
+        }
+        // slab test, the ray starts outside every box
+        for (const auto &box: boxes_) {
+            double t_near = 0, t_far = best;
+            bool hit = true;
+            for (int k = 0; k < 3 && hit; k++) {
+                if (std::abs(dir[k]) < 1e-12) {
+                    hit = origin[k] >= box.min[k] && origin[k] <= box.max[k];
+                    continue;
+                }
+                double t0 = (box.min[k] - origin[k]) / dir[k], t1 = (box.max[k] - origin[k]) / dir[k];
+                if (t0 > t1) {
+                    std::swap(t0, t1);
+                }
+                t_near = std::max(t_near, t0);
+                t_far = std::min(t_far, t1);
+                hit = t_near <= t_far;
+            }
+            if (hit && t_near > 0) {
+                best = t_near;
+            }
+        }
+        // vertical cylinders, only the side surface
+        double a = dir.x() * dir.x() + dir.y() * dir.y();
+        if (a > 1e-12) {
+            for (const auto &cylinder: cylinders_) {
+                double ox = origin.x() - cylinder.center.x(), oy = origin.y() - cylinder.center.y();
+                double b = ox * dir.x() + oy * dir.y();
+                double c = ox * ox + oy * oy - cylinder.radius * cylinder.radius;
+                double disc = b * b - a * c;
+                if (disc < 0) {
+                    continue;
+                }
+                double t = (-b - std::sqrt(disc)) / a;
+                if (t <= 0 || t >= best) {
+                    continue;
+                }
+                double z = origin.z() + t * dir.z();
+                if (z >= cylinder.z_min && z <= cylinder.z_max) {
+                    best = t;
+                }
+            }
+        }
+        return best;
+    }
+
+    pcl::PointCloud<pcl::PointXYZ>::Ptr SyntheticScene::scan(const Eigen::Matrix4d &pose, const LidarParams &lidar,
+                                                             unsigned seed) const {
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> noise(0, lidar.range_noise);
+        const Eigen::Matrix3d R = pose.block<3, 3>(0, 0);
+        const Eigen::Vector3d origin = pose.block<3, 1>(0, 3);
+
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+        cloud->reserve(lidar.num_beams * lidar.num_azimuths);
+        for (int beam = 0; beam < lidar.num_beams; beam++) {
+            double elevation = lidar.min_elevation + (lidar.max_elevation - lidar.min_elevation) * beam /
+                                                     std::max(1, lidar.num_beams - 1);
+            elevation *= M_PI / 180.0;
+            for (int az = 0; az < lidar.num_azimuths; az++) {
+                double azimuth = 2 * M_PI * az / lidar.num_azimuths;
+                Eigen::Vector3d dir_sensor(std::cos(elevation) * std::cos(azimuth),
+                                           std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+                double range = castRay(origin, R * dir_sensor, lidar.max_range);
+                if (range >= lidar.max_range) {
+                    continue;
+                }
+                range += noise(rng);
+                if (range < lidar.min_range) {
+                    continue;
+                }
+                Eigen::Vector3f p = (range * dir_sensor).cast<float>();
+                cloud->push_back(pcl::PointXYZ(p.x(), p.y(), p.z()));
+            }
+        }
+        cloud->width = cloud->size();
+        cloud->height = 1;
+        return cloud;
+    }
+
+    Eigen::Matrix4d StreetPose(double x, double y, double yaw_deg, double sensor_height) {
+        Eigen::Matrix4d pose = Eigen::Matrix4d::Identity();
+        pose.block<3, 3>(0, 0) = Eigen::AngleAxisd(yaw_deg * M_PI / 180.0, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+        pose.block<3, 1>(0, 3) = Eigen::Vector3d(x, y, sensor_height);
+        return pose;
+    }
+
+    SyntheticCorrespondences GenerateCorrespondences(const pcl::PointCloud<pcl::PointXYZ> &cloud,
+                                                     const CorrespondenceParams &params,
+                                                     pcl::PointCloud<pcl::PointXYZ> *tgt_cloud) {
+        if (cloud.empty()) {
+            throw std::runtime_error("GenerateCorrespondences: the source cloud is empty");
+        }
+        std::mt19937 rng(params.seed);
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+        std::uniform_int_distribution<size_t> pick(0, cloud.size() - 1);
+        std::normal_distribution<double> noise(0, params.noise);
+
+        SyntheticCorrespondences corrs;
+        Eigen::Vector3d axis(uniform(rng), uniform(rng), uniform(rng));
+        if (axis.norm() < 1e-6) {
+            axis = Eigen::Vector3d::UnitZ();
+        }
+        double angle = params.max_rotation * M_PI / 180.0 * uniform(rng);
+        corrs.T = Eigen::Matrix4d::Identity();
+        corrs.T.block<3, 3>(0, 0) = Eigen::AngleAxisd(angle, axis.normalized()).toRotationMatrix();
+        corrs.T.block<3, 1>(0, 3) = params.max_translation * Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng));
+        if (params.max_tilt >= 0) {
+            double roll = params.max_tilt * M_PI / 180.0 * uniform(rng);
+            double pitch = params.max_tilt * M_PI / 180.0 * uniform(rng);
+            corrs.T.block<3, 3>(0, 0) = (Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ()) *
+                                         Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY()) *
+                                         Eigen::AngleAxisd(roll, Eigen::Vector3d::UnitX())).toRotationMatrix();
+        }
+        const Eigen::Matrix3d R = corrs.T.block<3, 3>(0, 0);
+        const Eigen::Vector3d t = corrs.T.block<3, 1>(0, 3);
+
+        auto point = [&cloud](size_t i) {
+            return Eigen::Vector3d(cloud.points[i].x, cloud.points[i].y, cloud.points[i].z);
+        };
+        int num_outliers = std::round(params.num_corrs * params.outlier_ratio);
+        corrs.src.resize(params.num_corrs, 3);
+        corrs.tgt.resize(params.num_corrs, 3);
+        corrs.inlier.assign(params.num_corrs, 1);
+        for (int i = 0; i < num_outliers; i++) {
+            corrs.inlier[i] = 0;
+        }
+        std::shuffle(corrs.inlier.begin(), corrs.inlier.end(), rng);
+        for (int i = 0; i < params.num_corrs; i++) {
+            Eigen::Vector3d p = point(pick(rng));
+            Eigen::Vector3d q = corrs.inlier[i] ? p : point(pick(rng));
+            corrs.src.row(i) = p.transpose();
+            corrs.tgt.row(i) = (R * q + t + Eigen::Vector3d(noise(rng), noise(rng), noise(rng))).transpose();
+        }
+
+        if (tgt_cloud != nullptr) {
+            tgt_cloud->clear();
+            tgt_cloud->reserve(cloud.size());
+            for (size_t i = 0; i < cloud.size(); i++) {
+                Eigen::Vector3f q = (R * point(i) + t + Eigen::Vector3d(noise(rng), noise(rng), noise(rng)))
+                        .cast<float>();
+                tgt_cloud->push_back(pcl::PointXYZ(q.x(), q.y(), q.z()));
+            }
+            tgt_cloud->width = tgt_cloud->size();
+            tgt_cloud->height = 1;
+        }
+        return corrs;
+    }
+}
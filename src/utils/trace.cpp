@@ -0,0 +1,122 @@
+/**
+** Created by Zhijian QIAO.
+** UAV Group, Hong Kong University of Science and Technology
+** email: zqiaoac@connect.ust.hk
+**/
+
+#include "utils/trace.h"
+#include <map>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace g3reg {
+
+    std::atomic<bool> Tracer::enabled_(false);
+
+    Tracer &Tracer::instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void Tracer::setEnabled(bool enabled) {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    Tracer::ThreadBuffer &Tracer::threadBuffer() {
+        // the buffers live as long as the tracer, so a thread keeps its pointer until it exits
+        thread_local ThreadBuffer *buffer = nullptr;
+        if (buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffers_.emplace_back(new ThreadBuffer);
+            buffer = buffers_.back().get();
+            buffer->tid = buffers_.size() - 1;
+        }
+        return *buffer;
+    }
+
+    void Tracer::clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &buffer: buffers_) {
+            buffer->spans.clear();
+        }
+        origin_ns_ = now();
+    }
+
+    std::vector<TraceStats> Tracer::statistics() const {
+        std::map<std::pair<std::string, int>, std::vector<double>> durations;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto &buffer: buffers_) {
+                for (const auto &span: buffer->spans) {
+                    durations[{span.name, span.arg}].push_back((span.end_ns - span.begin_ns) / 1e6);
+                }
+            }
+        }
+        // nearest-rank percentile
+        auto percentile = [](const std::vector<double> &sorted, double p) {
+            size_t rank = std::ceil(p * sorted.size());
+            return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+        };
+        std::vector<TraceStats> stats;
+        for (auto &entry: durations) {
+            std::vector<double> &ms = entry.second;
+            std::sort(ms.begin(), ms.end());
+            TraceStats s;
+            s.stage = entry.first.first;
+            if (entry.first.second >= 0) {
+                s.stage += "[" + std::to_string(entry.first.second) + "]";
+            }
+            s.count = ms.size();
+            for (double t: ms) {
+                s.total_ms += t;
+            }
+            s.mean_ms = s.total_ms / s.count;
+            s.p50_ms = percentile(ms, 0.5);
+            s.p90_ms = percentile(ms, 0.9);
+            s.p99_ms = percentile(ms, 0.99);
+            s.max_ms = ms.back();
+            stats.push_back(s);
+        }
+        return stats;
+    }
+
+    bool Tracer::saveChromeTrace(const std::string &path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        for (const auto &buffer: buffers_) {
+            for (const auto &span: buffer->spans) {
+                // complete events, timestamps in microseconds
+                file << (first ? "\n" : ",\n") << "{\"name\": \"" << span.name << "\", \"ph\": \"X\", \"pid\": 0"
+                     << ", \"tid\": " << buffer->tid << ", \"ts\": " << (span.begin_ns - origin_ns_) / 1e3
+                     << ", \"dur\": " << (span.end_ns - span.begin_ns) / 1e3;
+                if (span.arg >= 0) {
+                    file << ", \"args\": {\"arg\": " << span.arg << "}";
+                }
+                file << "}";
+                first = false;
+            }
+        }
+        file << "\n]}\n";
+        return file.good();
+    }
+
+    bool Tracer::saveStatistics(const std::string &path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << "stage count total_ms mean_ms p50_ms p90_ms p99_ms max_ms\n" << std::fixed << std::setprecision(3);
+        for (const auto &s: statistics()) {
+            file << s.stage << " " << s.count << " " << s.total_ms << " " << s.mean_ms << " " << s.p50_ms << " "
+                 << s.p90_ms << " " << s.p99_ms << " " << s.max_ms << "\n";
+        }
+        return file.good();
+    }
+}